@@ -1,61 +1,65 @@
 /**
  * Provides a quick example WebSocket codec implementation "BinanceDepth". The
  * connection will listen for DepthDiffStreamEvent and push the to the provided
- * queue (or drop them if the queue is full).
+ * queue (and pause reading while a diff does not fit), or merge them into the
+ * provided DepthConflator.
  *
  * The connection is expected to drop after 24h (refer to public API docs)!
  */
 
 #pragma once
 
+#include <atomic>
 #include <binance_sbe/binance_sbe.hpp>
 #include <manet/protocol/websocket.hpp>
 #include <manet/utils/hexdump.hpp>
 #include <rigtorp/SPSCQueue.h>
 
-enum class Side : uint8_t
-{
-  bid,
-  ask
-};
+#include "conflation.hpp"
+#include "depth.hpp"
 
 namespace binance
 {
 
-enum class Symbol : uint8_t
+namespace log = manet::log;
+
+/** DepthEvents for the worker, with backpressure: a diff that does not fit
+ * pauses the connection and flags `paused`, the worker wakes the reactor
+ * (`Net::wake()`) once it drained the queue to half its capacity.
+ */
+struct DepthQueue
 {
-  BTC
+  explicit DepthQueue(std::size_t capacity)
+      : events(capacity)
+  {
+  }
+
+  rigtorp::SPSCQueue<DepthEvent> events;
+  std::atomic<bool> paused{false};
 };
 
-/** per-lever market depth diff */
-struct DepthEvent
+/** where BinanceDepth hands the diffs over to (`BinanceDepth::config_t`) */
+struct DepthSink
 {
-  Symbol symbol;
-  Side side;
-  int64_t event_time_ns; // remote time
-  int64_t update_id;
+  DepthQueue *queue = nullptr;
 
-  int64_t price_exp;
-  int64_t price;
-
-  int64_t qty_exp;
-  int64_t qty;
+  // merge the diffs instead of queueing every level (if set)
+  DepthConflator *conflator = nullptr;
 };
 
-namespace log = manet::log;
-
 /** WebSocket codec for Binance SBE depth stream: parse DepthDiffStreamEvent
  * messages and enqueue them per-level (as DepthEvent records) into spsc
- * queuspsc queue.
+ * queue, or merge them into the conflator. A diff is handed over whole or not
+ * at all (pause), so the book built from it never misses a level.
  */
 struct BinanceDepth
 {
   using Status = manet::protocol::Status;
 
-  using config_t = rigtorp::SPSCQueue<DepthEvent> *;
+  using config_t = DepthSink;
 
-  explicit BinanceDepth(config_t queue) noexcept
-      : _queue(queue)
+  explicit BinanceDepth(config_t sink) noexcept
+      : _sink(sink)
   {
   }
 
@@ -115,56 +119,109 @@ struct BinanceDepth
   }
 
 private:
-  rigtorp::SPSCQueue<DepthEvent> *_queue;
-  Status push_diff(
-    binance_sbe::messages::DepthDiffStreamEvent<const std::byte> diff
-  ) noexcept
+  using diff_t =
+    binance_sbe::messages::DepthDiffStreamEvent<const std::byte>;
+
+  DepthSink _sink;
+
+  Status push_diff(diff_t diff) noexcept
   {
-    for (auto &&ask : diff.asks())
+    std::size_t levels = diff.asks().size() + diff.bids().size();
+
+    if (_sink.conflator)
+    {
+      return merge_diff(diff, levels);
+    }
+
+    auto &events = _sink.queue->events;
+
+    if (events.capacity() < levels)
+    {
+      log::error("binance::DepthEvent diff exceeds the queue ({})", levels);
+      return Status::error;
+    }
+
+    // (the worker only frees space meanwhile)
+    if (events.capacity() - events.size() < levels)
+    {
+      _sink.queue->paused.store(true, std::memory_order_release);
+      return Status::pause;
+    }
+
+    bool pushed = for_each_level(
+      diff, [&](const DepthEvent &event) { return events.try_push(event); }
+    );
+
+    if (!pushed)
+    {
+      log::error("pushing binance::DepthEvent failed (queue full)");
+      return Status::error;
+    }
+
+    return Status::ok;
+  }
+
+  Status merge_diff(diff_t diff, std::size_t levels) noexcept
+  {
+    auto &conflator = *_sink.conflator;
+
+    if (conflator.max_levels() < levels)
     {
-      if (!_queue->try_push(
-            DepthEvent{
-              .symbol = Symbol::BTC,
-              .side = Side::ask,
-              .event_time_ns = diff.eventTime().value(),
-              .update_id = diff.lastBookUpdateId().value(),
-
-              .price_exp = diff.priceExponent().value(),
-              .price = ask.price().value(),
-
-              .qty_exp = diff.qtyExponent().value(),
-              .qty = ask.qty().value(),
-            }
-          ))
+      log::error("binance::DepthEvent diff exceeds the conflator ({})", levels);
+      return Status::error;
+    }
+
+    // (the worker wakes us once it drained the levels merged so far)
+    if (!conflator.begin(levels))
+    {
+      return Status::pause;
+    }
+
+    for_each_level(
+      diff,
+      [&](const DepthEvent &event)
       {
-        log::warn("pushing binance::DepthEvent failed (queue full)");
-        return Status::ok;
+        conflator.merge(event);
+        return true;
       }
+    );
+
+    conflator.commit();
+    return Status::ok;
+  }
+
+  /** `f(const DepthEvent &)` per level (asks first), stops when it fails */
+  template <typename F> static bool for_each_level(diff_t diff, F &&f) noexcept
+  {
+    auto level = [&](Side side, auto &&entry)
+    {
+      return f(DepthEvent{
+        .symbol = Symbol::BTC,
+        .side = side,
+        .event_time_ns = diff.eventTime().value(),
+        .update_id = diff.lastBookUpdateId().value(),
+
+        .price_exp = diff.priceExponent().value(),
+        .price = entry.price().value(),
+
+        .qty_exp = diff.qtyExponent().value(),
+        .qty = entry.qty().value(),
+      });
+    };
+
+    for (auto &&ask : diff.asks())
+    {
+      if (!level(Side::ask, ask))
+        return false;
     }
 
     for (auto &&bid : diff.bids())
     {
-      if (!_queue->try_push(
-            DepthEvent{
-              .symbol = Symbol::BTC,
-              .side = Side::bid,
-              .event_time_ns = diff.eventTime().value(),
-              .update_id = diff.lastBookUpdateId().value(),
-
-              .price_exp = diff.priceExponent().value(),
-              .price = bid.price().value(),
-
-              .qty_exp = diff.qtyExponent().value(),
-              .qty = bid.qty().value(),
-            }
-          ))
-      {
-        log::warn("pushing binance::DepthEvent failed (queue full)");
-        return Status::ok;
-      }
+      if (!level(Side::bid, bid))
+        return false;
     }
 
-    return Status::ok;
+    return true;
   }
 };
 
@@ -0,0 +1,175 @@
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "order_book.hpp"
+
+// replays depth diffs into an OrderBook: DepthEvents captured by the example
+// (`binance-sbe --capture <file>`), or a synthetic random walk without one.
+// reports updates per second and the latency of applying a diff
+
+using Clock = std::chrono::steady_clock;
+
+std::vector<binance::DepthEvent> read_capture(const char *path)
+{
+  std::vector<binance::DepthEvent> events;
+
+  FILE *file = std::fopen(path, "rb");
+  if (!file)
+  {
+    std::fprintf(stderr, "cannot open %s\n", path);
+    std::exit(1);
+  }
+
+  binance::DepthEvent event;
+  while (std::fread(&event, sizeof(event), 1, file) == 1)
+  {
+    events.push_back(event);
+  }
+
+  std::fclose(file);
+  return events;
+}
+
+std::vector<binance::DepthEvent> synthesize(std::size_t diffs)
+{
+  std::vector<binance::DepthEvent> events;
+
+  std::mt19937_64 rng(42);
+  int64_t mid = 10'000'000;
+
+  for (std::size_t id = 1; id <= diffs; id++)
+  {
+    mid += static_cast<int64_t>(rng() % 21) - 10;
+
+    for (auto n = rng() % 20 + 1; n > 0; n--)
+    {
+      bool bid = rng() & 1;
+
+      // mostly close to the mid, some far out
+      auto off = static_cast<int64_t>(rng() % 8 ? rng() % 200 : rng() % 20000);
+
+      events.push_back(binance::DepthEvent{
+        .symbol = binance::Symbol::BTC,
+        .side = bid ? Side::bid : Side::ask,
+        .event_time_ns = 0,
+        .update_id = static_cast<int64_t>(id),
+        .price_exp = -2,
+        .price = bid ? mid - off : mid + 1 + off,
+        .qty_exp = -8,
+        .qty = rng() % 3 ? static_cast<int64_t>(rng() % 100'000'000) : 0,
+      });
+    }
+  }
+
+  return events;
+}
+
+int main(int argc, char *argv[])
+{
+  const char *capture = nullptr;
+  std::size_t window = 1u << 12;
+
+  for (int i = 1; i < argc; i++)
+  {
+    if (std::string_view(argv[i]) == "--window" && i + 1 < argc)
+    {
+      window = std::stoul(argv[++i]);
+    }
+    else if (!capture && argv[i][0] != '-')
+    {
+      capture = argv[i];
+    }
+    else
+    {
+      std::fprintf(
+        stderr, "usage: %s [--window <prices>] [<capture>]\n", argv[0]
+      );
+      return 1;
+    }
+  }
+
+  auto events = capture ? read_capture(capture) : synthesize(1u << 20);
+
+  // a diff: the levels of one update
+  std::vector<std::span<const binance::DepthEvent>> diffs;
+  for (std::size_t i = 0, j; i < events.size(); i = j)
+  {
+    for (j = i + 1;
+         j < events.size() && events[j].update_id == events[i].update_id; j++)
+      ;
+
+    diffs.emplace_back(events.data() + i, j - i);
+  }
+
+  binance::OrderBook<> book(binance::Symbol::BTC, window);
+
+  // every latency is kept: quantiles are exact
+  std::vector<uint64_t> apply_ns;
+  apply_ns.reserve(diffs.size());
+
+  auto start = Clock::now();
+
+  for (auto diff : diffs)
+  {
+    auto t0 = Clock::now();
+    if (!book.apply(diff))
+    {
+      std::fprintf(stderr, "exponents changed, reloading\n");
+      book.clear();
+      book.apply(diff);
+    }
+    auto t1 = Clock::now();
+
+    apply_ns.push_back(static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count()
+    ));
+  }
+
+  std::chrono::duration<double> elapsed = Clock::now() - start;
+
+  uint64_t sum = 0;
+  for (auto ns : apply_ns)
+  {
+    sum += ns;
+  }
+
+  auto quantile = [&apply_ns](double q) -> uint64_t
+  {
+    if (apply_ns.empty())
+    {
+      return 0;
+    }
+
+    auto nth = apply_ns.begin() +
+               static_cast<std::ptrdiff_t>(
+                 q * static_cast<double>(apply_ns.size() - 1)
+               );
+    std::nth_element(apply_ns.begin(), nth, apply_ns.end());
+    return *nth;
+  };
+
+  uint64_t mean = apply_ns.empty() ? 0 : sum / apply_ns.size();
+  uint64_t p50 = quantile(0.5);
+  uint64_t p99 = quantile(0.99);
+  uint64_t max = quantile(1.0);
+
+  std::printf(
+    "%zu updates in %zu diffs: %.0f updates/s\n"
+    "apply (ns/diff): mean %" PRIu64 ", p50 %" PRIu64 ", p99 %" PRIu64
+    ", max %" PRIu64 "\n"
+    "book: %zu bids, %zu asks\n",
+    events.size(), diffs.size(),
+    static_cast<double>(events.size()) / elapsed.count(), mean, p50, p99,
+    max, book.bids().size(), book.asks().size()
+  );
+
+  return 0;
+}
@@ -15,9 +15,16 @@ struct option long_opts[] = {
   {"help", no_argument, nullptr, 'h'},
 #ifdef MANET_USE_FSTACK
   {"config", required_argument, nullptr, 'c'}, // forward to F-Stack
+#endif
+#ifdef MANET_USE_IO_URING
+  {"sqpoll", no_argument, nullptr, 's'},
+#elif !defined(MANET_USE_FSTACK)
+  {"busy-poll", required_argument, nullptr, 'b'},
 #endif
   {"net-cpu", required_argument, nullptr, 'n'},
   {"worker-cpu", required_argument, nullptr, 'w'},
+  {"conflate", no_argument, nullptr, 'C'},
+  {"capture", required_argument, nullptr, 'K'},
   {0, 0, 0, 0}
 };
 
@@ -31,9 +38,16 @@ void helpful_exit(char *pname, int status)
   fprintf(fout, "  -h, --help            show help\n");
 #ifdef MANET_USE_FSTACK
   fprintf(fout, "  -c <conf>             F-Stack config file\n");
+#endif
+#ifdef MANET_USE_IO_URING
+  fprintf(fout, "  --sqpoll              kernel thread polls submissions\n");
+#elif !defined(MANET_USE_FSTACK)
+  fprintf(fout, "  --busy-poll <usecs>   busy poll NIC queues for <usecs>\n");
 #endif
   fprintf(fout, "  --net-cpu <id>        pin network thread to CPU <id>\n");
   fprintf(fout, "  --worker-cpu <id>     pin worker thread to CPU <id>\n");
+  fprintf(fout, "  --conflate            merge depth diffs the worker lags\n");
+  fprintf(fout, "  --capture <file>      write depth events to <file>\n");
   if (manet::log::enabled)
   {
     fprintf(fout, "  -v|-vv              set verbose\n");
@@ -47,6 +61,8 @@ struct Args
   Net::config_t net_config;
   std::optional<int> net_cpu;
   std::optional<int> worker_cpu;
+  bool conflate;
+  std::string capture;
 };
 
 Args read_args(int argc, char *argv[])
@@ -57,6 +73,7 @@ Args read_args(int argc, char *argv[])
 #endif
   args.net_cpu = {};
   args.worker_cpu = {};
+  args.conflate = false;
 
   int c;
   int v_count = 0;
@@ -71,6 +88,12 @@ Args read_args(int argc, char *argv[])
     case 'n':
       args.net_cpu = std::stoi(optarg);
       break;
+    case 'C':
+      args.conflate = true;
+      break;
+    case 'K':
+      args.capture = optarg;
+      break;
     case 'h':
       helpful_exit(argv[0], 0);
       break;
@@ -78,6 +101,17 @@ Args read_args(int argc, char *argv[])
     case 'c':
       args.net_config = optarg;
       break;
+#endif
+#ifdef MANET_USE_IO_URING
+    case 's':
+      args.net_config.sqpoll = true;
+      break;
+#elif !defined(MANET_USE_FSTACK)
+    case 'b':
+      args.net_config.busy_poll_usecs = std::stoi(optarg);
+      args.net_config.socket_busy_poll_usecs = std::stoi(optarg);
+      args.net_config.prefer_busy_poll = true;
+      break;
 #endif
     case 'v':
       v_count++;
@@ -139,6 +173,8 @@ Config get_config(int argc, char *argv[])
     .api_key = std::move(api_key),
     // std::move(private_key),
     .net_cpu_id = args.net_cpu,
-    .worker_cpu_id = args.worker_cpu
+    .worker_cpu_id = args.worker_cpu,
+    .conflate = args.conflate,
+    .capture = std::move(args.capture)
   };
 }
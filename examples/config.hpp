@@ -2,10 +2,15 @@
 
 #include <memory>
 #include <openssl/evp.h>
+#include <optional>
+#include <string>
 
 #ifdef MANET_USE_FSTACK
 #include "manet/net/fstack.hpp"
 using Net = manet::net::FStack;
+#elif defined(MANET_USE_IO_URING)
+#include "manet/net/io_uring.hpp"
+using Net = manet::net::IoUring;
 #else
 #include "manet/net/epoll.hpp"
 using Net = manet::net::Epoll;
@@ -30,6 +35,12 @@ struct Config
 
   std::optional<int> net_cpu_id;
   std::optional<int> worker_cpu_id;
+
+  // merge depth diffs the worker did not take yet (DepthConflator)
+  bool conflate = false;
+
+  // write the depth events the worker applies to this file (book-bench)
+  std::string capture;
 };
 
 Config get_config(int argc, char *argv[]);
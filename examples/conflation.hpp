@@ -0,0 +1,205 @@
+/**
+ * Provides "DepthConflator": a handoff of depth diffs from the network thread
+ * to the worker that merges what the worker did not take yet. However far
+ * behind the worker is, it takes the latest quantity per (symbol, side,
+ * price) level of every diff merged since it last looked.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+#include "depth.hpp"
+
+namespace binance
+{
+
+/** Single producer, single consumer depth conflation.
+ *
+ * Levels are merged into one of two open-addressed (linear probing) tables,
+ * the slots written since the last `drain` are kept in a dirty list. `drain`
+ * swaps the tables and hands the dirty levels of the old one over: whole
+ * diffs only, as the tables are not swapped while a diff is merged. Neither
+ * side takes a lock, the producer never waits.
+ *
+ * A diff that might not fit the table (more distinct levels than
+ * `max_levels()` since the last `drain`) is refused, the producer pauses
+ * until `drain` reports it.
+ */
+class DepthConflator
+{
+public:
+  /** @param capacity slots per table (rounded up to a power of two) */
+  explicit DepthConflator(std::size_t capacity)
+      : _tables{Table(capacity), Table(capacity)}
+  {
+  }
+
+  /** distinct levels a table holds (up to 3/4 of the slots) */
+  std::size_t max_levels() const noexcept
+  {
+    return (_tables[0].mask + 1) / 4 * 3;
+  }
+
+  /* producer */
+
+  /** start merging a diff of `levels` levels, false if it may not fit (the
+   * producer paused, see `Drained::paused`) */
+  bool begin(std::size_t levels) noexcept
+  {
+    uint32_t state = _state.fetch_or(BUSY, std::memory_order_acquire);
+    _table = &_tables[state & TABLE];
+
+    if (_table->size + levels > max_levels())
+    {
+      _state.store(state | PAUSED, std::memory_order_release);
+      return false;
+    }
+
+    return true;
+  }
+
+  /** overwrite the level of `event` (between `begin` and `commit`) */
+  void merge(const DepthEvent &event) noexcept
+  {
+    Table &table = *_table;
+
+    std::size_t i = hash(event) & table.mask;
+    for (; table.slots[i].used; i = (i + 1) & table.mask)
+    {
+      auto &level = table.slots[i].event;
+      if (level.symbol == event.symbol && level.side == event.side &&
+          level.price == event.price)
+      {
+        level = event;
+        _merged++;
+        return;
+      }
+    }
+
+    table.slots[i] = {.event = event, .used = true};
+    table.dirty[table.size++] = static_cast<uint32_t>(i);
+  }
+
+  /** publish the diff merged since `begin` */
+  void commit() noexcept
+  {
+    uint32_t state = _state.load(std::memory_order_relaxed) & TABLE;
+    _state.store(state | DIRTY, std::memory_order_release);
+
+    if (_merged)
+    {
+      _conflated.fetch_add(_merged, std::memory_order_relaxed);
+      _merged = 0;
+    }
+  }
+
+  /* consumer */
+
+  struct Drained
+  {
+    std::size_t levels = 0;
+    bool paused = false; // the producer waits for room (wake it)
+  };
+
+  /** take the merged levels, `f(const DepthEvent &)` for each of them */
+  template <typename F> Drained drain(F &&f) noexcept
+  {
+    uint32_t state = _state.load(std::memory_order_acquire);
+    do
+    {
+      if (!(state & DIRTY))
+      {
+        return {};
+      }
+
+      // (the producer is done with a diff soon)
+      state &= ~BUSY;
+    } while (!_state.compare_exchange_weak(
+      state, (state ^ TABLE) & TABLE, std::memory_order_acq_rel,
+      std::memory_order_acquire
+    ));
+
+    Table &table = _tables[state & TABLE];
+    for (std::size_t i = 0; i < table.size; i++)
+    {
+      auto &slot = table.slots[table.dirty[i]];
+      f(std::as_const(slot.event));
+      slot.used = false;
+    }
+
+    Drained drained{.levels = table.size, .paused = (state & PAUSED) != 0};
+    _delivered.fetch_add(table.size, std::memory_order_relaxed);
+    table.size = 0;
+
+    return drained;
+  }
+
+  /* metrics (any thread) */
+
+  /** levels overwritten before the consumer took them */
+  uint64_t conflated() const noexcept
+  {
+    return _conflated.load(std::memory_order_relaxed);
+  }
+
+  /** levels handed to the consumer */
+  uint64_t delivered() const noexcept
+  {
+    return _delivered.load(std::memory_order_relaxed);
+  }
+
+private:
+  // state: the producer's table, it merges a diff (BUSY), there is something
+  // to drain (DIRTY), and it waits for room (PAUSED)
+  static constexpr uint32_t TABLE = 1;
+  static constexpr uint32_t BUSY = 2;
+  static constexpr uint32_t DIRTY = 4;
+  static constexpr uint32_t PAUSED = 8;
+
+  struct Slot
+  {
+    DepthEvent event;
+    bool used = false;
+  };
+
+  struct alignas(64) Table
+  {
+    explicit Table(std::size_t capacity)
+        : mask(std::bit_ceil(capacity < 4 ? 4 : capacity) - 1),
+          slots(std::make_unique<Slot[]>(mask + 1)),
+          dirty(std::make_unique<uint32_t[]>(mask + 1))
+    {
+    }
+
+    std::size_t mask;
+    std::unique_ptr<Slot[]> slots;
+    std::unique_ptr<uint32_t[]> dirty; // slots in use, in merge order
+    std::size_t size = 0;
+  };
+
+  static std::size_t hash(const DepthEvent &event) noexcept
+  {
+    uint64_t h = static_cast<uint64_t>(event.price) * 0x9e3779b97f4a7c15ull;
+    h ^= static_cast<uint64_t>(event.symbol) << 1 |
+         static_cast<uint64_t>(event.side);
+    return static_cast<std::size_t>(h ^ (h >> 32));
+  }
+
+  Table _tables[2];
+
+  // producer
+  Table *_table = nullptr;
+  uint64_t _merged = 0;
+
+  alignas(64) std::atomic<uint32_t> _state{0};
+  alignas(64) std::atomic<uint64_t> _conflated{0};
+  alignas(64) std::atomic<uint64_t> _delivered{0};
+};
+
+} // namespace binance
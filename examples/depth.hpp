@@ -0,0 +1,39 @@
+/**
+ * Market depth records handed from the network thread (BinanceDepth) to the
+ * worker thread.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+enum class Side : uint8_t
+{
+  bid,
+  ask
+};
+
+namespace binance
+{
+
+enum class Symbol : uint8_t
+{
+  BTC
+};
+
+/** per-lever market depth diff */
+struct DepthEvent
+{
+  Symbol symbol;
+  Side side;
+  int64_t event_time_ns; // remote time
+  int64_t update_id;
+
+  int64_t price_exp;
+  int64_t price;
+
+  int64_t qty_exp;
+  int64_t qty;
+};
+
+} // namespace binance
@@ -1,4 +1,5 @@
 #include <atomic>
+#include <chrono>
 #include <cinttypes>
 #include <csignal>
 #include <cstring>
@@ -17,9 +18,12 @@
 
 #include "binance_codec.hpp"
 #include "config.hpp"
+#include "order_book.hpp"
 
 // websocket connection using the codec defined in binance_codec.hpp
-using BinanceWebSocket = manet::protocol::WebSocket<binance::BinanceDepth>;
+// (SBE streams only send single-frame BINARY messages)
+using BinanceWebSocket = manet::protocol::WebSocket<
+  binance::BinanceDepth, manet::protocol::websocket::BinaryFeedPolicy>;
 
 // reactor that holds a single wss::/<BinanceDepth> connection
 using Reactor = manet::Reactor<
@@ -32,9 +36,12 @@ struct AppContext
 
   /** queue for depth diffs from the SBE WebSocket connection
    * - producer: BinanceDepth running on the `reactor` on network thread
-   * - consumer: `run_worker` on worker thread
+   * - consumer: `run_worker` on worker thread (wakes a paused producer)
    */
-  rigtorp::SPSCQueue<binance::DepthEvent> &depth_queue;
+  binance::DepthQueue &depth_queue;
+
+  /** replaces `depth_queue` with `--conflate` (same threads) */
+  binance::DepthConflator &depth_conflator;
 
   /** worker shutdown flag */
   std::atomic<bool> &shutdown;
@@ -76,6 +83,7 @@ void *run_net(void *arg)
 
   auto &config = context->config;
   auto &depth_queue = context->depth_queue;
+  auto &depth_conflator = context->depth_conflator;
   auto &reactor = context->reactor;
 
   if (!pin_thread(config.net_cpu_id))
@@ -90,12 +98,25 @@ void *run_net(void *arg)
       manet::ConnectionConfig<manet::transport::Tls, BinanceWebSocket>{
         "stream-sbe.binance.com",
         9443,                     // Net
-        "stream-sbe.binance.com", // Transport
+        // Transport
+        {.host = "stream-sbe.binance.com",
+         .port = 9443,
+         .groups = "X25519:P-256",
+         .alpn = "http/1.1"},
         // Protocol
         {.path = "/ws/btcusdt@depth",
          .extra = {{"X-MBX-APIKEY", config.api_key}},
          // Codec
-         .codec_config = &depth_queue}
+         .codec_config = {.queue = &depth_queue,
+                          .conflator =
+                            config.conflate ? &depth_conflator : nullptr},
+         .pong_deadline = std::chrono::seconds{10}},
+        // Options
+        {.deadlines = {.connect = std::chrono::seconds{3},
+                       .transport = std::chrono::seconds{3},
+                       .protocol = std::chrono::seconds{5},
+                       .close = std::chrono::seconds{2}},
+         .cork = true}
       }
     )
   );
@@ -105,13 +126,91 @@ void *run_net(void *arg)
   return nullptr;
 }
 
-/** worker thread: consumes depth events from depth_queue and logs them */
+/** the worker's L2 book, built from the depth events (and captures them) */
+struct DepthBook
+{
+  binance::OrderBook<> book{binance::Symbol::BTC};
+  FILE *capture = nullptr;
+
+  void apply(const binance::DepthEvent &e) noexcept
+  {
+    if (capture)
+    {
+      std::fwrite(&e, sizeof(e), 1, capture);
+    }
+
+    if (!book.apply(e))
+    {
+      std::fprintf(stderr, "depth exponents changed, rebuilding the book\n");
+      book.clear();
+      book.apply(e);
+    }
+  }
+
+  /** log the top of the book (after a whole diff) */
+  void print() const noexcept
+  {
+    auto bid = book.bids().best().value_or(binance::Level{0, 0});
+    auto ask = book.asks().best().value_or(binance::Level{0, 0});
+
+    // clang-format off
+    std::printf(
+      "%" PRId64 ": B %" PRId64 " @ %" PRId64 " | A %" PRId64 " @ %" PRId64
+      " (qty e%" PRId64 ", price e%" PRId64 ")\n",
+      book.update_id(),
+      bid.qty,
+      bid.price,
+      ask.qty,
+      ask.price,
+      book.qty_exp(),
+      book.price_exp()
+    );
+    // clang-format on
+  }
+};
+
+/** worker thread (`--conflate`): applies the merged depth levels */
+void run_conflated_worker(AppContext *context, DepthBook &depth)
+{
+  auto &conflator = context->depth_conflator;
+  auto &shutdown = context->shutdown;
+
+  while (!shutdown.load(std::memory_order_acquire))
+  {
+    auto drained =
+      conflator.drain([&](const binance::DepthEvent &e) { depth.apply(e); });
+
+    if (drained.levels)
+    {
+      depth.print();
+    }
+
+    // the codec paused reading: resume it, the levels it merged are taken
+    if (drained.paused)
+    {
+      Net::wake();
+    }
+
+    if (drained.levels == 0)
+    {
+      _mm_pause();
+    }
+  }
+
+  std::fprintf(
+    stderr, "depth levels: %" PRIu64 " delivered, %" PRIu64 " conflated\n",
+    conflator.delivered(), conflator.conflated()
+  );
+}
+
+/** worker thread: consumes depth events from depth_queue into the book */
 void *run_worker(void *arg)
 {
   auto *context = static_cast<AppContext *>(arg);
 
   auto &config = context->config;
   auto &depth_queue = context->depth_queue;
+  auto &events = depth_queue.events;
   auto &shutdown = context->shutdown;
 
   if (!pin_thread(config.worker_cpu_id))
@@ -119,24 +218,40 @@ void *run_worker(void *arg)
     std::abort();
   }
 
-  while (!shutdown.load(std::memory_order_acquire))
+  DepthBook depth;
+  if (!config.capture.empty() &&
+      !(depth.capture = std::fopen(config.capture.c_str(), "wb")))
   {
-    if (auto *ev = depth_queue.front())
+    std::fprintf(stderr, "cannot open %s\n", config.capture.c_str());
+    std::abort();
+  }
+
+  if (config.conflate)
+  {
+    run_conflated_worker(context, depth);
+  }
+
+  while (!config.conflate && !shutdown.load(std::memory_order_acquire))
+  {
+    // the codec paused reading: resume it once half the queue is free
+    if (depth_queue.paused.load(std::memory_order_acquire) &&
+        events.size() <= events.capacity() / 2 &&
+        depth_queue.paused.exchange(false, std::memory_order_acq_rel))
+    {
+      Net::wake();
+    }
+
+    if (auto *ev = events.front())
     {
-      auto e = *ev;
-      depth_queue.pop();
-
-      // clang-format off
-      std::printf(
-        "%" PRId64 ": %s %" PRId64 "e%" PRId64 " @ %" PRId64 "e%" PRId64 "\n",
-        e.event_time_ns,
-        e.side == Side::ask ? "A" : "B",
-        e.qty,
-        e.qty_exp,
-        e.price,
-        e.price_exp
-      );
-      // clang-format on
+      depth.apply(*ev);
+      events.pop();
+
+      // print between updates (the levels of a diff share its update id)
+      auto *next = events.front();
+      if (!next || next->update_id != depth.book.update_id())
+      {
+        depth.print();
+      }
     }
     else
     {
@@ -145,6 +260,11 @@ void *run_worker(void *arg)
     }
   }
 
+  if (depth.capture)
+  {
+    std::fclose(depth.capture);
+  }
+
   return nullptr;
 }
 
@@ -153,10 +273,11 @@ int main(int argc, char *argv[])
 {
   auto config = get_config(argc, argv);
 
-  alignas(128) rigtorp::SPSCQueue<binance::DepthEvent> queue{1u << 10};
+  alignas(128) binance::DepthQueue queue{1u << 10};
+  alignas(128) binance::DepthConflator conflator{1u << 12};
   alignas(128) std::atomic<bool> shutdown{false};
 
-  AppContext context{Reactor{}, config, queue, shutdown};
+  AppContext context{Reactor{}, config, queue, conflator, shutdown};
 
   pthread_t t_net, t_worker;
   g_main_thread = pthread_self();
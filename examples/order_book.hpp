@@ -0,0 +1,461 @@
+/**
+ * Provides "OrderBook": the L2 book the worker maintains from DepthEvents (and
+ * optionally a snapshot). Prices and quantities stay integer mantissas, their
+ * exponents are fixed per book.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "depth.hpp"
+
+namespace binance
+{
+
+/** price level (mantissas) */
+struct Level
+{
+  int64_t price;
+  int64_t qty;
+};
+
+/** One side of the book.
+ *
+ * Levels within a window of prices around the best one live in a ladder (an
+ * array indexed by price), updating them is O(1). Levels outside the window
+ * are kept sorted in a map. The window is moved (O(window)) when the best
+ * price leaves it.
+ *
+ * The best `N` levels are also kept contiguous, best first (`top_prices`,
+ * `top_qtys`), to scan them without chasing the ladder.
+ */
+template <Side S, std::size_t N> class BookSide
+{
+public:
+  static_assert(N > 0);
+
+  /** @param window prices in the ladder (rounded up to a power of two) */
+  explicit BookSide(std::size_t window)
+      : _ladder(std::bit_ceil(window < 2 ? 2 : window), 0)
+  {
+  }
+
+  /** is `a` a better price than `b` (higher bid, lower ask) */
+  static constexpr bool better(int64_t a, int64_t b) noexcept
+  {
+    if constexpr (S == Side::bid)
+      return a > b;
+    else
+      return a < b;
+  }
+
+  /** levels with a quantity */
+  std::size_t size() const noexcept { return _size; }
+  bool empty() const noexcept { return _size == 0; }
+
+  std::optional<Level> best() const noexcept
+  {
+    if (_top_size == 0)
+      return std::nullopt;
+
+    return Level{_top_price[0], _top_qty[0]};
+  }
+
+  /** quantity at `price` (0 if there is no such level) */
+  int64_t qty(int64_t price) const noexcept
+  {
+    if (in_ladder(price))
+      return _ladder[index(price)];
+
+    auto it = _far.find(price);
+    return it == _far.end() ? 0 : it->second;
+  }
+
+  /** the best min(N, size()) levels, best first */
+  std::span<const int64_t> top_prices() const noexcept
+  {
+    return {_top_price.data(), _top_size};
+  }
+
+  std::span<const int64_t> top_qtys() const noexcept
+  {
+    return {_top_qty.data(), _top_size};
+  }
+
+  /** quantity of the best `n` levels (at most N) */
+  int64_t depth(std::size_t n) const noexcept
+  {
+    int64_t sum = 0;
+    for (std::size_t i = 0; i < std::min(n, _top_size); i++)
+    {
+      sum += _top_qty[i];
+    }
+
+    return sum;
+  }
+
+  void clear() noexcept
+  {
+    std::fill(_ladder.begin(), _ladder.end(), 0);
+    _far.clear();
+    _top_size = 0;
+    _size = 0;
+    _centered = false;
+  }
+
+  /** set the quantity at `price` (0 removes the level) */
+  void set(int64_t price, int64_t qty)
+  {
+    if (!_centered)
+    {
+      center(price);
+    }
+
+    int64_t old = exchange(price, qty);
+
+    if (qty == 0)
+    {
+      if (old != 0)
+      {
+        _size--;
+        erase_top(price);
+      }
+    }
+    else
+    {
+      if (old == 0)
+      {
+        _size++;
+      }
+
+      update_top(price, qty);
+    }
+
+    // the best price left the window
+    if (_top_size && !in_ladder(_top_price[0]))
+    {
+      center(_top_price[0]);
+    }
+  }
+
+private:
+  std::vector<int64_t> _ladder;
+  int64_t _base = 0; // price of `_ladder[0]`
+  bool _centered = false;
+
+  std::map<int64_t, int64_t> _far;
+
+  alignas(64) std::array<int64_t, N> _top_price{};
+  alignas(64) std::array<int64_t, N> _top_qty{};
+  std::size_t _top_size = 0;
+
+  std::size_t _size = 0;
+
+  int64_t window() const noexcept
+  {
+    return static_cast<int64_t>(_ladder.size());
+  }
+
+  bool in_ladder(int64_t price) const noexcept
+  {
+    return _base <= price && price - _base < window();
+  }
+
+  std::size_t index(int64_t price) const noexcept
+  {
+    return static_cast<std::size_t>(price - _base);
+  }
+
+  /** set the quantity, returns the old one */
+  int64_t exchange(int64_t price, int64_t qty)
+  {
+    if (in_ladder(price))
+    {
+      return std::exchange(_ladder[index(price)], qty);
+    }
+
+    auto it = _far.find(price);
+    int64_t old = it == _far.end() ? 0 : it->second;
+
+    if (qty == 0)
+    {
+      if (it != _far.end())
+        _far.erase(it);
+    }
+    else if (it == _far.end())
+    {
+      _far.emplace(price, qty);
+    }
+    else
+    {
+      it->second = qty;
+    }
+
+    return old;
+  }
+
+  /** move the window to have `price` in the middle */
+  void center(int64_t price)
+  {
+    for (int64_t i = 0; i < window(); i++)
+    {
+      if (auto &qty = _ladder[static_cast<std::size_t>(i)])
+      {
+        _far.emplace(_base + i, qty);
+        qty = 0;
+      }
+    }
+
+    _base = price - window() / 2;
+    _centered = true;
+
+    auto it = _far.lower_bound(_base);
+    while (it != _far.end() && in_ladder(it->first))
+    {
+      _ladder[index(it->first)] = it->second;
+      it = _far.erase(it);
+    }
+  }
+
+  /** position of `price` in the top levels (where it would go) */
+  std::size_t top_position(int64_t price) const noexcept
+  {
+    std::size_t i = 0;
+    while (i < _top_size && better(_top_price[i], price))
+    {
+      i++;
+    }
+
+    return i;
+  }
+
+  void update_top(int64_t price, int64_t qty) noexcept
+  {
+    std::size_t i = top_position(price);
+
+    if (i < _top_size && _top_price[i] == price)
+    {
+      _top_qty[i] = qty;
+      return;
+    }
+
+    // (the top levels are the best ones: a level outside is worse than all)
+    if (i == N)
+    {
+      return;
+    }
+
+    std::size_t last = std::min(_top_size, N - 1);
+    std::copy_backward(
+      _top_price.begin() + i, _top_price.begin() + last,
+      _top_price.begin() + last + 1
+    );
+    std::copy_backward(
+      _top_qty.begin() + i, _top_qty.begin() + last, _top_qty.begin() + last + 1
+    );
+
+    _top_price[i] = price;
+    _top_qty[i] = qty;
+    _top_size = last + 1;
+  }
+
+  void erase_top(int64_t price) noexcept
+  {
+    std::size_t i = top_position(price);
+    if (i == _top_size || _top_price[i] != price)
+    {
+      return;
+    }
+
+    int64_t worst = _top_price[_top_size - 1];
+
+    std::copy(
+      _top_price.begin() + i + 1, _top_price.begin() + _top_size,
+      _top_price.begin() + i
+    );
+    std::copy(
+      _top_qty.begin() + i + 1, _top_qty.begin() + _top_size,
+      _top_qty.begin() + i
+    );
+    _top_size--;
+
+    // refill with the best level outside
+    if (_top_size < _size)
+    {
+      Level next = next_worse(worst);
+      _top_price[_top_size] = next.price;
+      _top_qty[_top_size] = next.qty;
+      _top_size++;
+    }
+  }
+
+  /** the best level worse than `price` (there is one) */
+  Level next_worse(int64_t price) const noexcept
+  {
+    std::optional<Level> level;
+
+    // the ladder, from `price` on (as far as it is in the window)
+    int64_t step = S == Side::bid ? -1 : 1;
+    int64_t i = price - _base + step;
+    i = S == Side::bid ? std::min(i, window() - 1) : std::max<int64_t>(i, 0);
+    for (; 0 <= i && i < window(); i += step)
+    {
+      if (auto qty = _ladder[static_cast<std::size_t>(i)])
+      {
+        level = Level{_base + i, qty};
+        break;
+      }
+    }
+
+    // the map, unless there is a better level in the ladder
+    if constexpr (S == Side::bid)
+    {
+      auto it = _far.lower_bound(price);
+      if (it != _far.begin())
+      {
+        --it;
+        if (!level || better(it->first, level->price))
+          level = Level{it->first, it->second};
+      }
+    }
+    else
+    {
+      auto it = _far.upper_bound(price);
+      if (it != _far.end() && (!level || better(it->first, level->price)))
+      {
+        level = Level{it->first, it->second};
+      }
+    }
+
+    return *level;
+  }
+};
+
+/** L2 order book of one symbol.
+ *
+ * Applies DepthEvents (the levels of depth diffs) on top of an optional
+ * snapshot: events of updates the snapshot includes are skipped. Without a
+ * snapshot the book takes the exponents of the first event.
+ *
+ * @tparam N levels per side kept contiguous (`BookSide::top_prices`)
+ */
+template <std::size_t N = 16> class OrderBook
+{
+public:
+  /** @param window prices per side kept in a ladder around the best one */
+  explicit OrderBook(Symbol symbol, std::size_t window = 1u << 12)
+      : _symbol(symbol), _bids(window), _asks(window)
+  {
+  }
+
+  const BookSide<Side::bid, N> &bids() const noexcept { return _bids; }
+  const BookSide<Side::ask, N> &asks() const noexcept { return _asks; }
+
+  /** last update applied (or loaded) */
+  int64_t update_id() const noexcept { return _update_id; }
+
+  int64_t price_exp() const noexcept { return _price_exp; }
+  int64_t qty_exp() const noexcept { return _qty_exp; }
+
+  void clear() noexcept
+  {
+    _bids.clear();
+    _asks.clear();
+    _snapshot_id = 0;
+    _update_id = 0;
+    _exps = false;
+  }
+
+  /** replace the book with a snapshot (as of `update_id`) */
+  void load(
+    int64_t update_id, int64_t price_exp, int64_t qty_exp,
+    std::span<const Level> bids, std::span<const Level> asks
+  )
+  {
+    clear();
+
+    _snapshot_id = _update_id = update_id;
+    _price_exp = price_exp;
+    _qty_exp = qty_exp;
+    _exps = true;
+
+    for (auto &level : bids)
+    {
+      _bids.set(level.price, level.qty);
+    }
+
+    for (auto &level : asks)
+    {
+      _asks.set(level.price, level.qty);
+    }
+  }
+
+  /** apply a level, false if its exponents are not the book's (reload it) */
+  bool apply(const DepthEvent &event)
+  {
+    if (event.symbol != _symbol || event.update_id <= _snapshot_id)
+    {
+      return true;
+    }
+
+    if (!_exps)
+    {
+      _price_exp = event.price_exp;
+      _qty_exp = event.qty_exp;
+      _exps = true;
+    }
+    else if (event.price_exp != _price_exp || event.qty_exp != _qty_exp)
+    {
+      return false;
+    }
+
+    if (event.side == Side::bid)
+    {
+      _bids.set(event.price, event.qty);
+    }
+    else
+    {
+      _asks.set(event.price, event.qty);
+    }
+
+    _update_id = std::max(_update_id, event.update_id);
+    return true;
+  }
+
+  /** apply a batch of levels (a diff), stops at the first that fails */
+  bool apply(std::span<const DepthEvent> events)
+  {
+    for (auto &event : events)
+    {
+      if (!apply(event))
+        return false;
+    }
+
+    return true;
+  }
+
+private:
+  Symbol _symbol;
+
+  BookSide<Side::bid, N> _bids;
+  BookSide<Side::ask, N> _asks;
+
+  int64_t _snapshot_id = 0;
+  int64_t _update_id = 0;
+
+  bool _exps = false;
+  int64_t _price_exp = 0;
+  int64_t _qty_exp = 0;
+};
+
+} // namespace binance
@@ -2,6 +2,7 @@
 
 #include <concepts>
 #include <cstddef>
+#include <span>
 #include <sys/socket.h>
 #include <sys/types.h>
 #include <utility>
@@ -28,22 +29,30 @@ concept Net = requires(
     Backend::socket(domain, type, proto)
   } noexcept -> std::same_as<typename Backend::fd_t>;
   { Backend::ioctl(fd, req, argp) } noexcept -> std::same_as<int>;
+  { Backend::bind(fd, sa, l) } noexcept -> std::same_as<int>;
   { Backend::connect(fd, sa, l) } noexcept -> std::same_as<int>;
   { Backend::close(fd) } noexcept -> std::same_as<int>;
 
   {
     Backend::getsockopt(fd, level, opt_name, opt_val, opt_len)
   } noexcept -> std::same_as<int>;
+  {
+    Backend::setsockopt(fd, level, opt_name, cptr, l)
+  } noexcept -> std::same_as<int>;
 
   { Backend::init(config) } -> std::same_as<void>;
   { Backend::run(loop, arg) };
 
-  { Backend::poll(events, len) } noexcept -> std::same_as<int>;
+  {
+    Backend::poll(events, len, poll_frequency_ms)
+  } noexcept -> std::same_as<int>;
 
   { Backend::signal() } noexcept;
+  { Backend::wake() } noexcept;
   { Backend::stop() } noexcept;
 
   { Backend::ev_signal(std::as_const(ev)) } noexcept -> std::same_as<bool>;
+  { Backend::ev_wake(std::as_const(ev)) } noexcept -> std::same_as<bool>;
   { Backend::ev_close(std::as_const(ev)) } noexcept -> std::same_as<bool>;
   { Backend::ev_error(std::as_const(ev)) } noexcept -> std::same_as<bool>;
   { Backend::ev_readable(std::as_const(ev)) } noexcept -> std::same_as<bool>;
@@ -51,6 +60,8 @@ concept Net = requires(
 
   { Backend::get_user_data(ev) } noexcept -> std::same_as<void *>;
 
+  // (re-)subscribing reports readiness that is already pending (like
+  // EPOLL_CTL_MOD re-arming an edge-triggered epoll)
   { Backend::subscribe(ptr, fd, true, false) } noexcept;
   { Backend::subscribe(ptr, fd, false, true) } noexcept;
   { Backend::subscribe(ptr, fd, true, true) } noexcept;
@@ -61,4 +72,20 @@ concept Net = requires(
   { Backend::clear(fd) } noexcept;
 };
 
+/** Net whose fds are kernel sockets (kTLS can be installed on them, their
+ * pages can be mapped for zero-copy receive) */
+template <typename Net>
+concept KernelSockets = requires {
+  requires Net::kernel_sockets;
+};
+
+/** Net that receives into buffers of its own: `lend` hands out the next
+ * received bytes in place instead of copying them like `read` (same results
+ * otherwise), they stay valid until the next `read` or `lend` of the fd */
+template <typename Net>
+concept LendsBuffers =
+  requires(typename Net::fd_t fd, std::span<const std::byte> &out) {
+    { Net::lend(fd, out) } noexcept -> std::same_as<ssize_t>;
+  };
+
 } // namespace manet::net
@@ -1,15 +1,179 @@
 #pragma once
 
+#include <arpa/inet.h>
 #include <cstdio>
+#include <cstring>
 #include <errno.h>
+#include <net/if.h>
 #include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <string>
 #include <string_view>
 #include <sys/ioctl.h>
 
+#include "manet/logging.hpp"
+
 namespace manet::net
 {
 
+/** socket tuning applied by `dial` (before connecting) */
+struct SocketOptions
+{
+  // TCP_NODELAY: small writes (pongs, orders) are not held back by Nagle
+  bool nodelay = true;
+
+  // TCP_QUICKACK: ACK right away instead of delaying, the kernel falls back
+  // to delayed ACKs so it is re-armed after reads
+  bool quickack = false;
+
+  // kernel buffer sizes (SO_RCVBUF/SO_SNDBUF, 0: autotuned)
+  int rcvbuf = 0;
+  int sndbuf = 0;
+
+  // queueing priority (SO_PRIORITY) and DSCP/TOS byte (IP_TOS), -1: default
+  int priority = -1;
+  int tos = -1;
+
+  // give up on the connection once sent data stays unacknowledged this long
+  // (TCP_USER_TIMEOUT, 0: default)
+  unsigned user_timeout_ms = 0;
+
+  // source address (numeric IPv4) and interface (SO_BINDTODEVICE)
+  std::string bind_address = "";
+  std::string bind_interface = "";
+};
+
+namespace detail
+{
+
+/** set an int option and read it back, `at_least`: the kernel may round the
+ * value up (buffers are doubled for bookkeeping) */
+template <typename Net>
+void set_option(
+  typename Net::fd_t fd, int level, int opt_name, const char *label, int value,
+  bool at_least = false, int mask = ~0
+) noexcept
+{
+  if (Net::setsockopt(fd, level, opt_name, &value, sizeof(value)) != 0)
+  {
+    log::warn("{}={} rejected ({}): {}", label, value, fd, strerror(errno));
+    return;
+  }
+
+  int actual = 0;
+  socklen_t len = sizeof(actual);
+
+  if (Net::getsockopt(fd, level, opt_name, &actual, &len) != 0)
+  {
+    log::warn("{}={} not verified ({}): {}", label, value, fd, strerror(errno));
+  }
+  else if (at_least ? actual < value : (actual & mask) != (value & mask))
+  {
+    log::warn("{}={} applied as {} ({})", label, value, actual, fd);
+  }
+  else
+  {
+    log::info("{}={} ({})", label, actual, fd);
+  }
+}
+
+/** apply `opts` to a fresh socket, false if it must not be used (it could
+ * not be bound as asked) */
+template <typename Net>
+bool apply(typename Net::fd_t fd, const SocketOptions &opts) noexcept
+{
+  if (opts.nodelay)
+  {
+    set_option<Net>(fd, IPPROTO_TCP, TCP_NODELAY, "TCP_NODELAY", 1);
+  }
+
+  if (opts.quickack)
+  {
+    set_option<Net>(fd, IPPROTO_TCP, TCP_QUICKACK, "TCP_QUICKACK", 1);
+  }
+
+  if (opts.rcvbuf > 0)
+  {
+    set_option<Net>(fd, SOL_SOCKET, SO_RCVBUF, "SO_RCVBUF", opts.rcvbuf, true);
+  }
+
+  if (opts.sndbuf > 0)
+  {
+    set_option<Net>(fd, SOL_SOCKET, SO_SNDBUF, "SO_SNDBUF", opts.sndbuf, true);
+  }
+
+  if (opts.priority >= 0)
+  {
+    set_option<Net>(fd, SOL_SOCKET, SO_PRIORITY, "SO_PRIORITY", opts.priority);
+  }
+
+  if (opts.tos >= 0)
+  {
+    // the kernel keeps the ECN bits for itself
+    set_option<Net>(fd, IPPROTO_IP, IP_TOS, "IP_TOS", opts.tos, false, ~0x03);
+  }
+
+  if (opts.user_timeout_ms > 0)
+  {
+    set_option<Net>(
+      fd, IPPROTO_TCP, TCP_USER_TIMEOUT, "TCP_USER_TIMEOUT",
+      static_cast<int>(opts.user_timeout_ms)
+    );
+  }
+
+  if (!opts.bind_interface.empty())
+  {
+    const auto &name = opts.bind_interface;
+
+    if (name.size() >= IFNAMSIZ)
+    {
+      log::error("invalid interface: {}", name);
+      errno = EINVAL;
+      return false;
+    }
+
+    if (Net::setsockopt(
+          fd, SOL_SOCKET, SO_BINDTODEVICE, name.c_str(), name.size() + 1
+        ) != 0)
+    {
+      log::error(
+        "SO_BINDTODEVICE={} failed ({}): {}", name, fd, strerror(errno)
+      );
+      return false;
+    }
+
+    log::info("SO_BINDTODEVICE={} ({})", name, fd);
+  }
+
+  if (!opts.bind_address.empty())
+  {
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+
+    if (inet_pton(AF_INET, opts.bind_address.c_str(), &addr.sin_addr) != 1)
+    {
+      log::error("invalid source address: {}", opts.bind_address);
+      errno = EINVAL;
+      return false;
+    }
+
+    if (Net::bind(fd, &addr, sizeof(addr)) != 0)
+    {
+      log::error(
+        "bind({}) failed ({}): {}", opts.bind_address, fd, strerror(errno)
+      );
+      return false;
+    }
+
+    log::info("bound to {} ({})", opts.bind_address, fd);
+  }
+
+  return true;
+}
+
+} // namespace detail
+
 template <typename Net> struct DialResult
 {
   typename Net::fd_t fd;
@@ -17,7 +181,8 @@ template <typename Net> struct DialResult
 };
 
 template <typename Net>
-DialResult<Net> dial(const char *host, uint16_t port) noexcept
+DialResult<Net>
+dial(const char *host, uint16_t port, const SocketOptions &opts = {}) noexcept
 {
   DialResult<Net> result = {.fd = -1, .err = ECONNREFUSED};
 
@@ -57,6 +222,13 @@ DialResult<Net> dial(const char *host, uint16_t port) noexcept
       continue;
     }
 
+    if (!detail::apply<Net>(socketfd, opts))
+    {
+      result.err = errno;
+      Net::close(socketfd);
+      continue;
+    }
+
     // attempt connection
     int ok = Net::connect(socketfd, ai->ai_addr, ai->ai_addrlen);
     if (ok == 0)
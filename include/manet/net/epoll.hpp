@@ -1,46 +1,85 @@
 #pragma once
 
 #include <cerrno>
+#include <cstdint>
 #include <cstdio>
 #include <sys/epoll.h>
 #include <unistd.h>
-#include <variant>
 
 namespace manet::net
 {
 
+/** epoll setup (`Epoll::config_t`): NAPI busy polling.
+ *
+ * Instead of sleeping until the NIC raises an interrupt, the kernel spins on
+ * the device's receive queue for a while (lower latency, at the cost of a
+ * busy CPU). Needs a NIC driver with NAPI and usually CAP_NET_ADMIN.
+ */
+struct EpollConfig
+{
+  // busy poll the queues of the epoll instance's sockets in `poll` (for up
+  // to `busy_poll_usecs`, `busy_poll_budget` packets at a time, 0: default)
+  std::uint32_t busy_poll_usecs = 0;
+  std::uint16_t busy_poll_budget = 0;
+
+  // busy poll every socket's queue on receive (SO_BUSY_POLL)
+  std::uint32_t socket_busy_poll_usecs = 0;
+
+  // keep device interrupts masked while busy polling (SO_PREFER_BUSY_POLL)
+  bool prefer_busy_poll = false;
+};
+
+/** what the kernel accepted of `EpollConfig` */
+struct EpollBusyPoll
+{
+  bool epoll = false;   // EPIOCSPARAMS (Linux 6.9+)
+  bool sockets = false; // SO_BUSY_POLL (and SO_PREFER_BUSY_POLL) so far
+};
+
 struct Epoll
 {
-  using config_t = std::monostate;
+  using config_t = EpollConfig;
   using fd_t = int;
   using event_t = epoll_event;
 
   static constexpr const char *name = "Epoll";
 
+  // fds are kernel sockets (kTLS capable)
+  static constexpr bool kernel_sockets = true;
+
   // sockets
   static fd_t socket(int domain, int type, int proto) noexcept;
   static int ioctl(fd_t fd, long req, void *argp) noexcept;
+  static int bind(fd_t fd, const void *sa, socklen_t l) noexcept;
   static int connect(fd_t fd, const void *sa, socklen_t l) noexcept;
   static int close(fd_t fd) noexcept;
 
   static int getsockopt(
     fd_t fd, int level, int opt_name, void *opt_val, socklen_t *opt_len
   ) noexcept;
+  static int setsockopt(
+    fd_t fd, int level, int opt_name, const void *opt_val, socklen_t opt_len
+  ) noexcept;
 
   static ssize_t read(fd_t fd, void *ptr, std::size_t len) noexcept;
   static ssize_t write(fd_t fd, const void *ptr, std::size_t len) noexcept;
 
   // reactor lifecycle
-  static void init(config_t);
+  static void init(config_t config);
   static void run(int (*loop)(void *arg), void *arg);
 
   static void signal() noexcept;
   static void stop() noexcept;
 
-  static int poll(event_t events[], std::size_t len) noexcept;
+  // interrupt `poll` from any thread (an `ev_wake` event, no kill signal)
+  static void wake() noexcept;
+
+  // wait up to `timeout_ms` for events (0: only report what is ready)
+  static int poll(event_t events[], std::size_t len, int timeout_ms) noexcept;
 
   // events
   static bool ev_signal(const event_t &ev) noexcept;
+  static bool ev_wake(const event_t &ev) noexcept;
   static bool ev_close(const event_t &ev) noexcept;
   static bool ev_error(const event_t &ev) noexcept;
   static bool ev_readable(const event_t &ev) noexcept;
@@ -48,6 +87,8 @@ struct Epoll
 
   static void *get_user_data(const event_t &ev) noexcept;
 
+  static EpollBusyPoll busy_poll() noexcept { return _busy_poll; }
+
   // event subscriptions
   static void
   subscribe(void *ptr, fd_t fd, bool want_read, bool want_write) noexcept
@@ -101,7 +142,11 @@ struct Epoll
 private:
   static int _event_fd;
   static int _signal_fd;
+  static int _wake_fd;
   static bool _alive;
+
+  static EpollConfig _config;
+  static EpollBusyPoll _busy_poll;
 };
 
 } // namespace manet::net
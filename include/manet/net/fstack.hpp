@@ -21,12 +21,16 @@ struct FStack
   // sockets
   static fd_t socket(int domain, int type, int proto) noexcept;
   static int ioctl(fd_t fd, long req, void *argp) noexcept;
+  static int bind(fd_t fd, const void *sa, socklen_t l) noexcept;
   static int connect(fd_t fd, const void *sa, socklen_t l) noexcept;
   static int close(fd_t fd) noexcept;
 
   static int getsockopt(
     fd_t fd, int level, int opt_name, void *opt_val, socklen_t *opt_len
   ) noexcept;
+  static int setsockopt(
+    fd_t fd, int level, int opt_name, const void *opt_val, socklen_t opt_len
+  ) noexcept;
 
   static ssize_t read(fd_t fd, void *buf, std::size_t len) noexcept;
   static ssize_t write(fd_t fd, const void *buf, std::size_t len) noexcept;
@@ -35,13 +39,18 @@ struct FStack
   static void init(config_t config);
   static void run(int (*loop)(void *arg), void *arg);
 
-  static int poll(event_t events[], std::size_t len) noexcept;
+  // wait up to `timeout_ms` for events (0: only report what is ready)
+  static int poll(event_t events[], std::size_t len, int timeout_ms) noexcept;
 
   static void signal() noexcept;
   static void stop() noexcept;
 
+  // interrupt `poll` (an `ev_wake` event, no kill signal)
+  static void wake() noexcept;
+
   // events
   static bool ev_signal(const event_t &ev) noexcept;
+  static bool ev_wake(const event_t &ev) noexcept;
   static bool ev_close(const event_t &ev) noexcept;
   static bool ev_error(const event_t &ev) noexcept;
   static bool ev_readable(const event_t &ev) noexcept;
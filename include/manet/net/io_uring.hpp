@@ -0,0 +1,112 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <poll.h>
+#include <span>
+#include <sys/socket.h>
+#include <sys/types.h>
+
+namespace manet::net
+{
+
+/** io_uring setup (`IoUring::config_t`) */
+struct IoUringConfig
+{
+  unsigned entries = 256; // submission queue entries
+
+  // provided receive buffers (a power of two) and their size
+  unsigned buffers = 256;
+  unsigned buffer_size = 1 << 14;
+
+  // a kernel thread polls the submission queue (no submit syscalls while it
+  // is awake, it sleeps after `sqpoll_idle_ms` without submissions)
+  bool sqpoll = false;
+  unsigned sqpoll_idle_ms = 1000;
+};
+
+/** Linux io_uring backend.
+ *
+ * A socket subscribed for reading keeps one multishot recv armed: for every
+ * receive the kernel picks a buffer of a registered provided-buffer ring and
+ * posts a completion. Completions are queued per socket until `read` copies
+ * them out or `lend` hands them out in place (either gives the buffers back),
+ * writeability is a one-shot POLLOUT.
+ * Kernels that do not pick buffers from the ring get them provided by SQEs.
+ *
+ * Submissions are batched and flushed by `poll`, which only enters the kernel
+ * when there are no completions to reap (or, without SQPOLL, to submit): under
+ * load receiving takes no syscalls at all.
+ *
+ * Completions are reported as (edge-triggered) readiness events, so the
+ * backend is a drop-in for Epoll. Sockets stay plain kernel sockets, but
+ * their data is owned by the ring (no kTLS).
+ */
+struct IoUring
+{
+  using config_t = IoUringConfig;
+  using fd_t = int;
+
+  struct event_t
+  {
+    void *ptr = nullptr;
+    uint32_t events = 0; // POLLIN, POLLOUT, POLLERR, POLLHUP, SIGNAL or WAKE
+  };
+
+  static constexpr const char *name = "io_uring";
+
+  static constexpr uint32_t SIGNAL = 1u << 31;
+  static constexpr uint32_t WAKE = 1u << 30;
+
+  // sockets
+  static fd_t socket(int domain, int type, int proto) noexcept;
+  static int ioctl(fd_t fd, long req, void *argp) noexcept;
+  static int bind(fd_t fd, const void *sa, socklen_t l) noexcept;
+  static int connect(fd_t fd, const void *sa, socklen_t l) noexcept;
+  static int close(fd_t fd) noexcept;
+
+  static int getsockopt(
+    fd_t fd, int level, int opt_name, void *opt_val, socklen_t *opt_len
+  ) noexcept;
+  static int setsockopt(
+    fd_t fd, int level, int opt_name, const void *opt_val, socklen_t opt_len
+  ) noexcept;
+
+  static ssize_t read(fd_t fd, void *ptr, std::size_t len) noexcept;
+  static ssize_t write(fd_t fd, const void *ptr, std::size_t len) noexcept;
+
+  // the next received buffer in place: valid until the next `read` or `lend`
+  // (what `read` would copy out of it, see `net::LendsBuffers`)
+  static ssize_t lend(fd_t fd, std::span<const std::byte> &out) noexcept;
+
+  // reactor lifecycle
+  static void init(config_t config);
+  static void run(int (*loop)(void *arg), void *arg);
+
+  static void signal() noexcept;
+  static void stop() noexcept;
+
+  // interrupt `poll` from any thread (an `ev_wake` event, no kill signal)
+  static void wake() noexcept;
+
+  // wait up to `timeout_ms` for events (0: only report what is ready)
+  static int poll(event_t events[], std::size_t len, int timeout_ms) noexcept;
+
+  // events
+  static bool ev_signal(const event_t &ev) noexcept;
+  static bool ev_wake(const event_t &ev) noexcept;
+  static bool ev_close(const event_t &ev) noexcept;
+  static bool ev_error(const event_t &ev) noexcept;
+  static bool ev_readable(const event_t &ev) noexcept;
+  static bool ev_writeable(const event_t &ev) noexcept;
+
+  static void *get_user_data(const event_t &ev) noexcept;
+
+  // event subscriptions
+  static void
+  subscribe(void *ptr, fd_t fd, bool want_read, bool want_write) noexcept;
+
+  static void clear(fd_t fd) noexcept;
+};
+
+} // namespace manet::net
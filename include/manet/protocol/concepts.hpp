@@ -21,9 +21,23 @@ concept ConnectHandler = requires(typename P::Session &ctx, reactor::IO io) {
 template <typename P>
 concept HasHeartbeat = requires { (void)&P::Session::heartbeat; };
 
+/** `heartbeat` is called periodically; returning `Status::close` drops the
+ * connection without a graceful shutdown (peer considered dead) so the reactor
+ * reconnects it. */
 template <typename P>
 concept Heartbeat = requires(P::Session &ctx, reactor::TxSink output) {
-  { ctx.heartbeat(output) } noexcept -> std::same_as<void>;
+  { ctx.heartbeat(output) } noexcept -> std::same_as<Status>;
+};
+
+template <typename P>
+concept HasResume = requires { (void)&P::Session::on_resume; };
+
+/** `on_resume` is called once reading resumes after a `Status::pause`. The
+ * heartbeat skips a paused connection (it reads nothing, so it would look
+ * dead): liveness clocks start over here. */
+template <typename P>
+concept Resume = requires(P::Session &ctx) {
+  { ctx.on_resume() } noexcept -> std::same_as<void>;
 };
 
 template <typename P>
@@ -42,6 +56,39 @@ concept Teardown = requires(P::Session &ctx) {
   { ctx.teardown() } noexcept -> std::same_as<Status>;
 };
 
+template <typename P>
+concept HasEstablished = requires { (void)&P::Session::established; };
+
+/** `established()` is true once the protocol handshake (for example the
+ * WebSocket upgrade) completed, it bounds the protocol deadline. */
+template <typename P>
+concept Established = requires(const typename P::Session &ctx) {
+  { ctx.established() } noexcept -> std::same_as<bool>;
+};
+
+template <typename P>
+concept HasReadTarget = requires { (void)&P::Session::read_target; };
+
+/** `read_target()` returns where the next transport read should land (nullptr
+ * for RX); it is only used while RX is empty and `on_data` is called with the
+ * landed bytes accounted in the target. */
+template <typename P>
+concept ReadTarget = requires(typename P::Session &ctx) {
+  { ctx.read_target() } noexcept -> std::same_as<reactor::ReadTarget *>;
+};
+
+template <typename P>
+concept HasReset = requires { (void)&P::Session::reset; };
+
+/** `reset(config)` prepares the Session for the next connection attempt in
+ * place (instead of a new Session), keeping what does not change per attempt.
+ */
+template <typename P>
+concept Reset =
+  requires(typename P::Session &ctx, typename P::config_t &config) {
+    { ctx.reset(config) } noexcept -> std::same_as<void>;
+  };
+
 template <typename P>
 concept Protocol =
   requires(
@@ -52,7 +99,10 @@ concept Protocol =
     { ctx.on_data(io) } noexcept -> std::same_as<Status>;
   } &&
   (!HasConnectHandler<P> || ConnectHandler<P>) &&
-  (!HasHeartbeat<P> || Heartbeat<P>) && (!HasShutdown<P> || Shutdown<P>) &&
-  (!HasTeardown<P> || Teardown<P>);
+  (!HasHeartbeat<P> || Heartbeat<P>) && (!HasResume<P> || Resume<P>) &&
+  (!HasShutdown<P> || Shutdown<P>) &&
+  (!HasTeardown<P> || Teardown<P>) &&
+  (!HasEstablished<P> || Established<P>) &&
+  (!HasReadTarget<P> || ReadTarget<P>) && (!HasReset<P> || Reset<P>);
 
 } // namespace manet::protocol
@@ -6,12 +6,18 @@
 namespace manet::protocol
 {
 
-/** protocol layer status */
+/** protocol layer status
+ *
+ * `pause`: stop reading (backpressure), unconsumed input stays in RX. The
+ * Connection hands it over again once woken (`Net::wake()`), TCP flow control
+ * pushes back on the peer in the meantime.
+ */
 enum class Status : uint8_t
 {
   ok,
   close,
-  error
+  error,
+  pause
 };
 
 [[nodiscard]] constexpr std::string_view to_string(Status status)
@@ -24,6 +30,8 @@ enum class Status : uint8_t
     return "close";
   case Status::error:
     return "error";
+  case Status::pause:
+    return "pause";
   }
 }
 
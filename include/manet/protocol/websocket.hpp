@@ -1,15 +1,19 @@
 #pragma once
 
+#include <chrono>
 #include <cstring>
+#include <memory>
 #include <vector>
 
 #include "manet/logging.hpp"
 #include "manet/protocol/status.hpp"
 #include "manet/reactor/io.hpp"
 #include "manet/utils/hexdump.hpp"
+#include "manet/utils/histogram.hpp"
 
 #include "websocket_concepts.hpp"
 #include "websocket_frame.hpp"
+#include "websocket_policy.hpp"
 
 namespace manet::protocol
 {
@@ -23,19 +27,93 @@ struct Header
   std::string value;
 };
 
+/** connection health (shared by the reconnects of a connection) */
+struct Stats
+{
+  utils::Histogram rtt_ns; // PING -> PONG round trips
+
+  uint64_t pong_timeouts = 0;  // dropped: PONG overdue
+  uint64_t stale_timeouts = 0; // dropped: no data
+};
+
 namespace detail
 {
 
-struct Handshake
+/** Upgrade request compiled once per Session (which reconnects keep, see
+ * `Session::reset`): host, path and extra headers are fixed, only the 24 byte
+ * Sec-WebSocket-Key hole changes per connect. */
+struct RequestTemplate
 {
-  std::string upgrade_request;
-  std::array<char, 28> ws_accept_key;
+  static constexpr std::size_t CAP = 4096;
+  static constexpr std::size_t KEY_LEN = 24;
+
+  std::array<char, CAP> buf;
+  std::size_t len = 0; // 0 if the request did not fit
+  std::size_t key_offset = 0;
 };
 
-Handshake make_handshake(
+RequestTemplate compile_request(
   std::string_view host, std::string_view path, std::span<const Header> extra
 ) noexcept;
 
+/** fill the key hole with a fresh nonce, write the request to `output` and
+ * compute the expected Sec-WebSocket-Accept (returns 0 if it does not fit) */
+std::size_t write_request(
+  RequestTemplate &request, std::span<std::byte> output,
+  std::array<char, 28> &ws_accept_key
+) noexcept;
+
+/** Resumable parser state for the HTTP upgrade response.
+ *
+ * Remembers the offset of the first unparsed line so an incomplete response is
+ * never rescanned. Header values are kept as offsets relative to `rbuf()` (the
+ * response stays unconsumed until it is complete).
+ */
+struct HandshakeParser
+{
+  static constexpr std::size_t MAX_RESPONSE = 1 << 14;
+
+  enum class Field : uint8_t
+  {
+    accept,     // Sec-WebSocket-Accept
+    extensions, // Sec-WebSocket-Extensions
+    protocol,   // Sec-WebSocket-Protocol
+  };
+
+  struct Value
+  {
+    uint32_t offset = 0;
+    uint32_t len = 0;
+    bool found = false;
+  };
+
+  std::size_t scan = 0;     // start of the next unparsed line
+  bool status_line = false; // status line was parsed
+  uint16_t status = 0;      // HTTP status code (0 if malformed)
+
+  std::array<Value, 3> fields{};
+
+  const Value &operator[](Field field) const noexcept
+  {
+    return fields[static_cast<std::size_t>(field)];
+  }
+
+  std::string_view
+  value(Field field, std::span<const std::byte> input) const noexcept
+  {
+    const auto &v = (*this)[field];
+    return {reinterpret_cast<const char *>(input.data()) + v.offset, v.len};
+  }
+};
+
+/** feed the (possibly incomplete) HTTP response in `in`, consumes the response
+ * once it is complete. */
+Status read_handshake(
+  HandshakeParser &parser, std::array<char, 28> ws_accept_key,
+  reactor::RxSource in
+) noexcept;
+
+/** one-shot variant of the above (an incomplete response is rescanned) */
 Status read_handshake(
   std::array<char, 28> ws_accept_key, reactor::RxSource in
 ) noexcept;
@@ -49,8 +127,8 @@ void random_bytes(std::byte *buf, std::size_t len) noexcept;
 
 } // namespace detail
 
-template <typename Codec>
-  requires MessageCodec<Codec>
+template <typename Codec, typename Policy = DefaultPolicy>
+  requires MessageCodec<Codec> && websocket::Policy<Policy>
 struct WebSocket
 {
   struct config_t
@@ -59,22 +137,54 @@ struct WebSocket
     std::vector<Header> extra;
 
     typename Codec::config_t codec_config{};
+
+    /** drop (and reconnect) if our PING is not answered in time (0: never) */
+    std::chrono::milliseconds pong_deadline{0};
+
+    /** drop (and reconnect) if nothing arrived for this long (0: never) */
+    std::chrono::milliseconds stale_after{0};
+
+    Stats *stats = nullptr;
   };
 
   struct Session
   {
-    static constexpr std::size_t MSG_CAP = 1 << 20;
+    static constexpr std::size_t MSG_CAP = Policy::max_message_size;
+    static constexpr std::size_t BATCH_CAP = 64;
 
-    std::string_view host;
-    std::string path;
-    std::vector<Header> extra;
+    /** frames missing at least this many payload bytes are read straight into
+     * `msg_buf` or streamed to the codec (shorter tails are read through RX,
+     * where one read can also carry the following frames) */
+    static constexpr std::size_t DIRECT_MIN = 1 << 12;
 
     std::size_t msg_len = 0;
 
+    // frame whose payload is still in flight (if 0 < remaining)
+    detail::frame_header partial{};
+    uint64_t remaining = 0;
+    reactor::ReadTarget target{};
+
+    // a BINARY message is being streamed to the codec (on_binary_begin sent)
+    bool streaming = false;
+
+    // the message in `msg_buf` waits for the codec (it paused)
+    bool held = false;
+
     std::array<char, 28> ws_accept_key{};
+    detail::HandshakeParser response{};
 
     detail::OpCode opcode;
 
+    using clock = std::chrono::steady_clock;
+
+    clock::time_point ping_sent{}; // our PING in flight (epoch: none)
+    clock::time_point last_rx{};   // last on_data (if stale_after is set)
+
+    clock::duration pong_deadline;
+    clock::duration stale_after;
+
+    Stats *stats;
+
     enum class State : uint8_t
     {
       idle,
@@ -82,33 +192,59 @@ struct WebSocket
       listening
     } state = State::idle;
 
-    std::array<std::byte, MSG_CAP> msg_buf{};
+    [[no_unique_address]] std::array<std::byte, MSG_CAP> msg_buf{};
+
+    detail::RequestTemplate request;
 
     Codec codec;
 
     Session(std::string_view host, uint16_t /*port*/, config_t &config) noexcept
-        : host(host),
-          path(config.path),
-          extra(config.extra),
+        : pong_deadline(config.pong_deadline),
+          stale_after(config.stale_after),
+          stats(config.stats),
+          request(detail::compile_request(host, config.path, config.extra)),
           codec(config.codec_config)
     {
     }
 
-    Status on_connect(reactor::IO output) noexcept
+    /** the next connection attempt: everything but the compiled request
+     * starts over (the codec is rebuilt) */
+    void reset(config_t &config) noexcept
     {
-      auto handshake = detail::make_handshake(host, path, extra);
-      auto out = output.wbuf();
+      msg_len = 0;
+      partial = {};
+      remaining = 0;
+      target = {};
+      streaming = false;
+      held = false;
+
+      ws_accept_key = {};
+      response = {};
+      opcode = {};
+
+      ping_sent = {};
+      last_rx = {};
+      pong_deadline = config.pong_deadline;
+      stale_after = config.stale_after;
+      stats = config.stats;
+
+      state = State::idle;
+
+      std::destroy_at(&codec);
+      std::construct_at(&codec, config.codec_config);
+    }
 
-      auto len = handshake.upgrade_request.size();
-      if (out.size() < len)
+    Status on_connect(reactor::IO output) noexcept
+    {
+      auto len = detail::write_request(request, output.wbuf(), ws_accept_key);
+      if (len == 0)
       {
         return Status::error;
       }
 
-      ws_accept_key = handshake.ws_accept_key;
+      response = {};
       state = State::handshake_sent;
 
-      std::memcpy(out.data(), handshake.upgrade_request.data(), len);
       output.wrote(len);
 
       return Status::ok;
@@ -122,18 +258,43 @@ struct WebSocket
       {
         auto before = io.rbuf().size();
 
-        auto status = detail::read_handshake(ws_accept_key, io);
+        auto status = detail::read_handshake(response, ws_accept_key, io);
 
         // if we consumed the HTTP frame and are ok then start listening
         if (io.rbuf().size() != before && status == Status::ok)
         {
           state = State::listening;
+          last_rx = clock::now();
         }
 
         return status;
       }
       case State::listening:
-        return dispatch_frame(io);
+      {
+        if (0 < stale_after.count())
+        {
+          last_rx = clock::now();
+        }
+
+        if (held)
+        {
+          if (auto status = deliver(io); status != Status::ok)
+          {
+            return status;
+          }
+        }
+
+        if (0 < remaining)
+        {
+          if (auto status = continue_partial(io);
+              status != Status::ok || 0 < remaining)
+          {
+            return status;
+          }
+        }
+
+        return dispatch_frames(io);
+      }
 
       default:
         break;
@@ -161,106 +322,443 @@ struct WebSocket
       return 0 < sent ? Status::close : Status::error;
     }
 
-    void heartbeat(reactor::TxSink out) noexcept
+    bool established() const noexcept { return state == State::listening; }
+
+    reactor::ReadTarget *read_target() noexcept
     {
-      std::span<const std::byte> payload{};
-      out.wrote(
-        detail::write_control_frame(out.wbuf(), detail::OpCode::ping, payload)
-      );
+      // streamed payloads are handed to the codec from RX
+      return 0 < remaining && !streaming ? &target : nullptr;
     }
 
-  private:
-    Status dispatch_frame(reactor::IO io) noexcept
+    /** send a PING carrying its send time (one at a time if a PONG deadline
+     * is set), drop the connection if the PONG is overdue or the stream went
+     * stale. */
+    Status heartbeat(reactor::TxSink out) noexcept
     {
-      auto input = io.rbuf();
+      if (state != State::listening)
+      {
+        return Status::ok;
+      }
+
+      auto now = clock::now();
+      bool in_flight = ping_sent != clock::time_point{};
+
+      if (0 < pong_deadline.count() && in_flight &&
+          pong_deadline < now - ping_sent)
+      {
+        log::warn("WebSocket: PONG overdue");
+        if (stats)
+        {
+          stats->pong_timeouts++;
+        }
 
-      // attempt reading the frame
-      detail::parse_output parsed;
+        return Status::close;
+      }
 
-      switch (detail::parse_frame(input, parsed))
+      if (0 < stale_after.count() && stale_after < now - last_rx)
       {
-      case detail::parse_status::ok:
+        log::warn("WebSocket: no data received (stale)");
+        if (stats)
+        {
+          stats->stale_timeouts++;
+        }
+
+        return Status::close;
+      }
+
+      if (0 < pong_deadline.count() && in_flight)
       {
-        // successful parse: read bytes and advance input
-        io.read(parsed.consumed);
+        return Status::ok; // still waiting for the PONG
+      }
 
-        auto payload = parsed.frame.payload;
+      auto ts = now.time_since_epoch().count();
 
-        // An unfragmented message consists of a single frame with the FIN
-        // bit set (Section 5.2) and an opcode other than 0.
+      std::array<std::byte, sizeof(ts)> payload;
+      std::memcpy(payload.data(), &ts, sizeof(ts));
 
-        // A fragmented message consists of a single frame with the FIN bit
-        // clear and an opcode other than 0, followed by zero or more frames
-        // with the FIN bit clear and the opcode set to 0, and terminated by
-        // a single frame with the FIN bit set and an opcode of 0.
-        if (!parsed.frame.fin || parsed.frame.op == detail::OpCode::cont)
+      auto len =
+        detail::write_control_frame(out.wbuf(), detail::OpCode::ping, payload);
+
+      if (0 < len)
+      {
+        out.wrote(len);
+        ping_sent = now;
+      }
+
+      return Status::ok;
+    }
+
+    /** reading resumed after a pause: the PING in flight and the stream's
+     * silence were not the peer's doing, start their clocks over */
+    void on_resume() noexcept
+    {
+      ping_sent = {};
+      last_rx = clock::now();
+    }
+
+  private:
+    /** parse and dispatch every complete frame in `rbuf()` in one pass.
+     *
+     * Complete single-frame BINARY messages are collected and handed to
+     * `on_binary_batch` (if the codec declares it), any other frame flushes
+     * the pending batch first to keep message order.
+     */
+    Status dispatch_frames(reactor::IO io) noexcept
+    {
+      [[maybe_unused]] std::array<detail::frame_view, BATCH_CAP> batch;
+      [[maybe_unused]] std::size_t batched = 0;
+
+      auto flush = [&]() noexcept
+      {
+        if constexpr (Policy::binary && HasBinaryBatchHandler<Codec>)
         {
-          if (MSG_CAP < msg_len + payload.size())
+          if (0 < batched)
           {
-            log::error("msg buffer overflow");
-            return Status::error;
-          }
+            log::trace("WebSocket::BINARY (batch of {})", batched);
 
-          if (parsed.frame.payload_len != payload.size())
-          {
-            log::error("unexpected payload size");
-            return Status::error;
+            auto frames =
+              std::span<const detail::frame_view>{batch}.first(batched);
+            batched = 0;
+
+            // (the batch is consumed already)
+            return no_pause(codec.on_binary_batch(io, frames));
           }
+        }
+
+        return Status::ok;
+      };
+
+      while (true)
+      {
+        auto input = io.rbuf();
 
-          memcpy(msg_buf.data() + msg_len, payload.data(), payload.size());
-          msg_len += payload.size();
+        // attempt reading the frame
+        detail::parse_output parsed;
 
-          if (parsed.frame.fin)
+        switch (detail::parse_frame(input, parsed))
+        {
+        case detail::parse_status::ok:
+          break;
+        case detail::parse_status::need_more:
+        {
+          log::trace(
+            "need more, rxbuf[{}]:\n{}", input.size(), utils::hexdump(input)
+          );
+          if (auto status = flush(); status != Status::ok)
           {
-            auto status = handle_frame(
-              io, opcode, std::span<const std::byte>{msg_buf}.first(msg_len)
-            );
+            return status;
+          }
+          return begin_partial(io);
+        }
+        case detail::parse_status::masked_server:
+        {
+          log::error("server-to-client frame must not be masked");
+          return Status::error;
+        }
+        case detail::parse_status::bad_reserved:
+        {
+          log::error("RSV bits set");
+          return Status::error;
+        }
+        }
 
-            // clear message buffer
-            msg_len = 0;
+        // successful parse: read bytes and advance input (payloads stay valid
+        // until on_data returns, RX is not written to in the meantime)
+        if constexpr (Policy::binary && HasBinaryBatchHandler<Codec>)
+        {
+          if (parsed.frame.fin && parsed.frame.op == detail::OpCode::binary)
+          {
+            io.read(parsed.consumed);
+            batch[batched++] = parsed.frame;
 
-            if (status != Status::ok)
+            if (batched == BATCH_CAP)
             {
-              return status;
+              if (auto status = flush(); status != Status::ok)
+              {
+                return status;
+              }
             }
+            continue;
           }
-          else if (parsed.frame.op != detail::OpCode::cont)
+
+          if (auto status = flush(); status != Status::ok)
           {
-            opcode = parsed.frame.op;
+            return status;
           }
         }
-        else
+
+        auto status = dispatch_frame(io, parsed.frame);
+
+        // paused: the frame stays in RX (unless its message is held)
+        if (status == Status::pause && !held)
+        {
+          return status;
+        }
+
+        io.read(parsed.consumed);
+
+        if (status != Status::ok)
         {
-          auto status = handle_frame(io, parsed.frame.op, payload);
+          return status;
+        }
+      }
+    }
 
-          if (status != Status::ok)
-          {
-            return status;
-          }
+    Status
+    dispatch_frame(reactor::IO io, const detail::frame_view &frame) noexcept
+    {
+      auto payload = frame.payload;
+
+      if constexpr (!Policy::fragmentation)
+      {
+        if (!frame.fin || frame.op == detail::OpCode::cont)
+        {
+          log::error("fragmented message (disabled by policy)");
+          return Status::error;
+        }
+
+        return handle_frame(io, frame.op, payload);
+      }
+
+      if constexpr (Policy::binary && HasBinaryStreamHandler<Codec>)
+      {
+        if ((frame.op == detail::OpCode::binary && !frame.fin) ||
+            (frame.op == detail::OpCode::cont && streaming))
+        {
+          return stream(io, frame.op, payload, frame.fin);
+        }
+      }
+
+      // An unfragmented message consists of a single frame with the FIN
+      // bit set (Section 5.2) and an opcode other than 0.
+
+      // A fragmented message consists of a single frame with the FIN bit
+      // clear and an opcode other than 0, followed by zero or more frames
+      // with the FIN bit clear and the opcode set to 0, and terminated by
+      // a single frame with the FIN bit set and an opcode of 0.
+      if (!frame.fin || frame.op == detail::OpCode::cont)
+      {
+        if (MSG_CAP < msg_len + payload.size())
+        {
+          log::error("msg buffer overflow");
+          return Status::error;
         }
 
+        if (frame.payload_len != payload.size())
+        {
+          log::error("unexpected payload size");
+          return Status::error;
+        }
+
+        memcpy(msg_buf.data() + msg_len, payload.data(), payload.size());
+        msg_len += payload.size();
+
+        return end_fragment(io, frame.op, frame.fin);
+      }
+
+      return handle_frame(io, frame.op, payload);
+    }
+
+    /** the payload of a frame is complete in `msg_buf` */
+    Status end_fragment(reactor::IO io, detail::OpCode op, bool fin) noexcept
+    {
+      if (op != detail::OpCode::cont)
+      {
+        opcode = op;
+      }
+
+      if (!fin)
+      {
         return Status::ok;
       }
-      case detail::parse_status::need_more:
+
+      return deliver(io);
+    }
+
+    /** hand the message in `msg_buf` to the codec (kept while it pauses) */
+    Status deliver(reactor::IO io) noexcept
+    {
+      auto status = handle_frame(
+        io, opcode, std::span<const std::byte>{msg_buf}.first(msg_len)
+      );
+
+      held = status == Status::pause;
+
+      // clear message buffer
+      if (!held)
+      {
+        msg_len = 0;
+      }
+
+      return status;
+    }
+
+    /** streamed and batched messages are consumed: they can not pause */
+    static Status no_pause(Status status) noexcept
+    {
+      if (status == Status::pause)
+      {
+        log::error("WebSocket: only whole messages can pause");
+        return Status::error;
+      }
+
+      return status;
+    }
+
+    /** RX ends with an incomplete frame: if a large data payload is missing,
+     * move what arrived to `msg_buf` and read the rest straight into it. */
+    Status begin_partial(reactor::IO io) noexcept
+    {
+      auto input = io.rbuf();
+
+      if (detail::parse_header(input, partial) != detail::parse_status::ok)
+      {
+        return Status::ok; // incomplete header
+      }
+
+      // control frames are short, they always wait in RX
+      if (partial.op != detail::OpCode::text &&
+          partial.op != detail::OpCode::binary &&
+          partial.op != detail::OpCode::cont)
+      {
+        return Status::ok;
+      }
+
+      if constexpr (!Policy::fragmentation)
+      {
+        if (!partial.fin || partial.op == detail::OpCode::cont)
+        {
+          log::error("fragmented message (disabled by policy)");
+          return Status::error;
+        }
+      }
+
+      auto available = input.size() - partial.len;
+
+      if (partial.payload_len - available < DIRECT_MIN)
+      {
+        return Status::ok;
+      }
+
+      if constexpr (Policy::binary && HasBinaryStreamHandler<Codec>)
+      {
+        if (partial.op == detail::OpCode::binary ||
+            (partial.op == detail::OpCode::cont && streaming))
+        {
+          io.read(input.size());
+          remaining = partial.payload_len - available;
+
+          log::trace("WebSocket: streaming {} payload bytes", remaining);
+
+          return stream(io, partial.op, input.subspan(partial.len), false);
+        }
+      }
+
+      if constexpr (MSG_CAP == 0)
+      {
+        return Status::ok; // no message buffer: wait in RX
+      }
+      else
       {
-        log::trace(
-          "need more, rxbuf[{}]:\n{}", input.size(), utils::hexdump(input)
+        if (MSG_CAP - msg_len < partial.payload_len)
+        {
+          log::error("msg buffer overflow");
+          return Status::error;
+        }
+
+        std::memcpy(
+          msg_buf.data() + msg_len, input.data() + partial.len, available
         );
+        io.read(input.size());
+
+        msg_len += available;
+        remaining = partial.payload_len - available;
+
+        target = {.buf = std::span{msg_buf}.subspan(msg_len, remaining)};
+
+        log::trace("WebSocket: reading {} payload bytes directly", remaining);
+
         return Status::ok;
       }
-      case detail::parse_status::masked_server:
+    }
+
+    /** account for payload bytes that landed in `target` or RX */
+    Status continue_partial(reactor::IO io) noexcept
+    {
+      if constexpr (Policy::binary && HasBinaryStreamHandler<Codec>)
       {
-        log::error("server-to-client frame must not be masked");
-        return Status::error;
+        if (streaming)
+        {
+          auto input = io.rbuf();
+          auto n = std::min<std::size_t>(remaining, input.size());
+
+          io.read(n);
+          remaining -= n;
+
+          return stream(
+            io, detail::OpCode::cont, input.first(n),
+            remaining == 0 && partial.fin
+          );
+        }
       }
-      case detail::parse_status::bad_reserved:
+
+      msg_len += target.len;
+      remaining -= target.len;
+
+      // bytes that were read through RX (no target handed out)
+      auto input = io.rbuf();
+      auto n = std::min<std::size_t>(remaining, input.size());
+
+      std::memcpy(msg_buf.data() + msg_len, input.data(), n);
+      io.read(n);
+
+      msg_len += n;
+      remaining -= n;
+
+      if (0 < remaining)
       {
-        log::error("RSV bits set");
-        return Status::error;
+        target = {.buf = std::span{msg_buf}.subspan(msg_len, remaining)};
+        return Status::ok;
       }
+
+      target = {};
+
+      return end_fragment(io, partial.op, partial.fin);
+    }
+
+    /** hand (part of) a BINARY message to the codec */
+    Status stream(
+      reactor::IO io, detail::OpCode op, std::span<const std::byte> chunk,
+      bool last
+    ) noexcept
+    {
+      if (op == detail::OpCode::binary)
+      {
+        streaming = true;
+
+        if (auto status = no_pause(codec.on_binary_begin(io));
+            status != Status::ok)
+        {
+          return status;
+        }
       }
 
-      return Status::error;
+      if (!chunk.empty())
+      {
+        if (auto status = no_pause(codec.on_binary_chunk(io, chunk));
+            status != Status::ok)
+        {
+          return status;
+        }
+      }
+
+      if (last)
+      {
+        streaming = false;
+        return no_pause(codec.on_binary_end(io));
+      }
+
+      return Status::ok;
     }
 
     Status handle_frame(
@@ -277,7 +775,12 @@ struct WebSocket
       case detail::OpCode::text:
       {
         log::trace("WebSocket::TEXT");
-        if constexpr (HasTextHandler<Codec>)
+        if constexpr (!Policy::text)
+        {
+          log::error("TEXT message (disabled by policy)");
+          return Status::error;
+        }
+        else if constexpr (HasTextHandler<Codec>)
         {
           return codec.on_text(io, payload);
         }
@@ -287,10 +790,19 @@ struct WebSocket
       case detail::OpCode::binary:
       {
         log::trace("WebSocket::BINARY");
-        if constexpr (HasBinaryHandler<Codec>)
+        if constexpr (!Policy::binary)
+        {
+          log::error("BINARY message (disabled by policy)");
+          return Status::error;
+        }
+        else if constexpr (HasBinaryHandler<Codec>)
         {
           return codec.on_binary(io, payload);
         }
+        else if constexpr (HasBinaryStreamHandler<Codec>)
+        {
+          return stream(io, opcode, payload, true);
+        }
         else
         {
           return Status::ok;
@@ -331,6 +843,12 @@ struct WebSocket
       }
       case detail::OpCode::ping:
       {
+        if constexpr (!Policy::control)
+        {
+          log::trace("WebSocket::PING (ignored by policy)");
+          return Status::ok;
+        }
+
         std::size_t len = payload.size();
         if (126 <= len)
         {
@@ -358,6 +876,33 @@ struct WebSocket
       }
       case detail::OpCode::pong:
       {
+        // our PING echoed back: payload is the send time
+        clock::rep ts;
+        if (payload.size() != sizeof(ts))
+        {
+          break;
+        }
+
+        std::memcpy(&ts, payload.data(), sizeof(ts));
+        auto sent = clock::time_point{clock::duration{ts}};
+
+        if (sent != ping_sent)
+        {
+          break; // unsolicited or stale PONG
+        }
+
+        ping_sent = {};
+
+        auto rtt = std::chrono::duration_cast<std::chrono::nanoseconds>(
+          clock::now() - sent
+        );
+
+        log::trace("WebSocket::PONG (rtt: {}ns)", rtt.count());
+
+        if (stats)
+        {
+          stats->rtt_ns.record(static_cast<uint64_t>(rtt.count()));
+        }
         break;
       }
       }
@@ -365,11 +910,16 @@ struct WebSocket
       return Status::ok;
     }
   };
+
+  static_assert(
+    sizeof(Session) - sizeof(Codec) <= Policy::session_budget,
+    "WebSocket::Session exceeds the policy's size budget"
+  );
 };
 
 } // namespace websocket
 
-template <typename Codec>
-using WebSocket = protocol::websocket::WebSocket<Codec>;
+template <typename Codec, typename Policy = websocket::DefaultPolicy>
+using WebSocket = protocol::websocket::WebSocket<Codec, Policy>;
 
 } // namespace manet::protocol
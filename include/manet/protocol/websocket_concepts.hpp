@@ -27,6 +27,30 @@ concept BinaryHandler =
     { codec.on_binary(io, payload) } noexcept -> std::same_as<Status>;
   };
 
+template <typename Codec>
+concept HasBinaryBatchHandler = requires { (void)&Codec::on_binary_batch; };
+
+/** complete single-frame BINARY messages parsed from one read, in order */
+template <typename Codec>
+concept BinaryBatchHandler = requires(
+  Codec &codec, reactor::IO io, std::span<const detail::frame_view> frames
+) {
+  { codec.on_binary_batch(io, frames) } noexcept -> std::same_as<Status>;
+};
+
+template <typename Codec>
+concept HasBinaryStreamHandler = requires { (void)&Codec::on_binary_chunk; };
+
+/** BINARY messages delivered as they arrive: fragmented messages and frames
+ * with a large payload in flight are not buffered (nor bounded by MSG_CAP) */
+template <typename Codec>
+concept BinaryStreamHandler =
+  requires(Codec &codec, reactor::IO io, std::span<const std::byte> chunk) {
+    { codec.on_binary_begin(io) } noexcept -> std::same_as<Status>;
+    { codec.on_binary_chunk(io, chunk) } noexcept -> std::same_as<Status>;
+    { codec.on_binary_end(io) } noexcept -> std::same_as<Status>;
+  };
+
 template <typename Codec>
 concept HasShutdownHandler = requires { (void)&Codec::on_shutdown; };
 
@@ -38,6 +62,10 @@ concept ShutdownHandler = requires(Codec &codec) {
 template <typename Codec>
 concept MessageCodec = (!HasTextHandler<Codec> || TextHandler<Codec>) &&
                        (!HasBinaryHandler<Codec> || BinaryHandler<Codec>) &&
+                       (!HasBinaryBatchHandler<Codec> ||
+                        BinaryBatchHandler<Codec>) &&
+                       (!HasBinaryStreamHandler<Codec> ||
+                        BinaryStreamHandler<Codec>) &&
                        (!HasShutdownHandler<Codec> || ShutdownHandler<Codec>);
 
 } // namespace manet::protocol::websocket
@@ -63,9 +63,18 @@ constexpr OpCode to_op(uint8_t b0) noexcept
 constexpr bool masked(uint8_t b1) noexcept { return (b1 & 0x80) != 0; }
 constexpr uint8_t len7(uint8_t b1) noexcept { return uint8_t(b1 & 0x7F); }
 
-// single pass, non-throwing parse view
+struct frame_header
+{
+  OpCode op;
+  bool fin;
+
+  uint64_t payload_len;
+  std::size_t len; // header bytes
+};
+
+/** parse the frame header only (the payload may still be in flight) */
 inline parse_status
-parse_frame(std::span<const std::byte> in, parse_output &out) noexcept
+parse_header(std::span<const std::byte> in, frame_header &out) noexcept
 {
   if (in.size() < 2)
   {
@@ -114,19 +123,38 @@ parse_frame(std::span<const std::byte> in, parse_output &out) noexcept
     hdr += 8;
   }
 
-  if (in.size() < hdr + len)
+  out.op = to_op(b0);
+  out.fin = fin_bit(b0);
+  out.payload_len = len;
+  out.len = hdr;
+
+  return parse_status::ok;
+}
+
+// single pass, non-throwing parse view
+inline parse_status
+parse_frame(std::span<const std::byte> in, parse_output &out) noexcept
+{
+  frame_header header;
+
+  if (auto status = parse_header(in, header); status != parse_status::ok)
+  {
+    return status;
+  }
+
+  if (in.size() - header.len < header.payload_len)
   {
     return parse_status::need_more;
   }
 
   // set outputs
-  out.frame.op = to_op(b0);
-  out.frame.fin = fin_bit(b0);
+  out.frame.op = header.op;
+  out.frame.fin = header.fin;
 
-  out.frame.payload_len = len;
-  out.frame.payload = std::span<const std::byte>(in.subspan(hdr, size_t(len)));
+  out.frame.payload_len = header.payload_len;
+  out.frame.payload = in.subspan(header.len, size_t(header.payload_len));
 
-  out.consumed = hdr + size_t(len);
+  out.consumed = header.len + size_t(header.payload_len);
 
   return parse_status::ok;
 }
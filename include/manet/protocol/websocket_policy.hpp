@@ -0,0 +1,61 @@
+#pragma once
+
+#include <concepts>
+#include <cstddef>
+
+namespace manet::protocol::websocket
+{
+
+/**
+ * Compile-time feature set of a WebSocket<Codec, Policy> session.
+ *
+ * Disabled features are compiled out of the Session; receiving a frame that
+ * needs one is a protocol error.
+ *
+ * - max_message_size: capacity of the message buffer used for fragmented
+ *   messages and large frames read in place (0: no message buffer, messages
+ *   must fit RX as single frames)
+ *
+ * - fragmentation: accept messages split over several frames (FIN=0, CONT)
+ *
+ * - text, binary: accept TEXT or BINARY messages
+ *
+ * - control: answer PING with PONG (CLOSE is always handled)
+ *
+ * - session_budget: upper bound for sizeof(Session) excluding the codec
+ */
+template <typename P>
+concept Policy = requires {
+  { P::max_message_size } -> std::convertible_to<std::size_t>;
+  { P::fragmentation } -> std::convertible_to<bool>;
+  { P::text } -> std::convertible_to<bool>;
+  { P::binary } -> std::convertible_to<bool>;
+  { P::control } -> std::convertible_to<bool>;
+  { P::session_budget } -> std::convertible_to<std::size_t>;
+};
+
+/** everything RFC 6455 allows (without extensions) */
+struct DefaultPolicy
+{
+  static constexpr std::size_t max_message_size = 1 << 20;
+  static constexpr bool fragmentation = true;
+  static constexpr bool text = true;
+  static constexpr bool binary = true;
+  static constexpr bool control = true;
+
+  static constexpr std::size_t session_budget = max_message_size + (1 << 13);
+};
+
+/** market data feeds that send single-frame BINARY messages (e.g. SBE) */
+struct BinaryFeedPolicy
+{
+  static constexpr std::size_t max_message_size = 0;
+  static constexpr bool fragmentation = false;
+  static constexpr bool text = false;
+  static constexpr bool binary = true;
+  static constexpr bool control = true;
+
+  static constexpr std::size_t session_budget = 1 << 13;
+};
+
+} // namespace manet::protocol::websocket
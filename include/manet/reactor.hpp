@@ -1,7 +1,10 @@
 #pragma once
 
+#include <chrono>
+
 #include "logging.hpp"
 #include "reactor/connection.hpp"
+#include "reactor/ready.hpp"
 
 namespace manet
 {
@@ -16,6 +19,8 @@ template <typename Transport, typename Protocol> struct ConnectionConfig
 
   typename Transport::config_t transport_config;
   typename Protocol::config_t protocol_config;
+
+  ConnectionOptions options{};
 };
 
 /** Statically known set of connections.
@@ -23,7 +28,19 @@ template <typename Transport, typename Protocol> struct ConnectionConfig
  * `.run()` starts an infinite event loop polling the network for new edge
  * events and handles them. Gracefully closed connections are restarted.
  *
- * Heartbeat every ~6.3 seconds.
+ * Connections with a read budget (`Scheduling`) that still have data queue
+ * up in a ready list, which is served (heaviest first) after every poll: one
+ * busy connection can not starve the others. While connections are ready,
+ * polling does not block.
+ *
+ * A protocol paused by backpressure (`protocol::Status::pause`) is retried
+ * on `Net::wake()`, which its consumer calls once it made room.
+ *
+ * Heartbeat every ~6.4 seconds (by the clock: a loop that does not block does
+ * not speed it up) and per-phase deadlines (checked every loop iteration),
+ * connections dropped by either are restarted as well. Sockets a connection
+ * parked with zero-copy sends in flight are closed (every loop iteration)
+ * once the kernel released them.
  *
  * `Net::stop()` will terminate the event loop.
  *
@@ -53,6 +70,7 @@ public:
     }
 
     manet::log::info("entering poll loop");
+    next_heartbeat = std::chrono::steady_clock::now() + heartbeat_interval;
     Net::run(loop, this);
   }
 
@@ -79,7 +97,7 @@ private:
     auto &opt = std::get<I>(connections);
     opt.emplace(
       std::move(config.host), config.port, std::move(config.transport_config),
-      std::move(config.protocol_config)
+      std::move(config.protocol_config), config.options
     );
 
     Conn *conn = std::addressof(*opt);
@@ -87,14 +105,21 @@ private:
   }
 
   std::array<event_t, NUM_EVENTS> events{};
+  ReadyList<Net, NUM_CONNECTIONS> ready{};
 
-  static inline uint64_t counter = 0;
+  static constexpr std::chrono::milliseconds heartbeat_interval{
+    64 * net::poll_frequency_ms
+  };
+  std::chrono::steady_clock::time_point next_heartbeat{};
 
   static int loop(void *data) noexcept
   {
     auto *self = static_cast<Reactor *>(data);
 
-    int nevents = Net::poll(self->events.data(), NUM_EVENTS);
+    int nevents = Net::poll(
+      self->events.data(), NUM_EVENTS,
+      self->ready.empty() ? net::poll_frequency_ms : 0
+    );
     if (nevents < 0)
     {
       manet::log::error("poll failed");
@@ -116,6 +141,10 @@ private:
           self->stop_all();
         }
       }
+      else if (Net::ev_wake(ev))
+      {
+        self->wake_all();
+      }
       else
       {
         auto conn = static_cast<BaseConnection<Net> *>(Net::get_user_data(ev));
@@ -128,21 +157,38 @@ private:
           {
             conn->restart();
           }
+
+          self->ready.push(conn);
         }
       }
+    }
 
-      if (self->stopping && self->all_done())
+    // another round for connections that spent their read budget
+    self->ready.resume(
+      [self](BaseConnection<Net> *conn)
       {
-        Net::stop();
+        if (!self->stopping && conn->closed())
+        {
+          conn->restart();
+        }
       }
-    }
+    );
 
-    // ~every 6.3 seconds (aligned with timeouts)
-    if ((++counter & 63) == 0)
+    auto now = std::chrono::steady_clock::now();
+    self->timeouts(now);
+
+    if (self->next_heartbeat <= now)
     {
+      self->next_heartbeat = now + self->heartbeat_interval;
       self->heartbeat();
     }
 
+    // (the last connection may also close without an event: a deadline)
+    if (self->stopping && self->all_done())
+    {
+      Net::stop();
+    }
+
     return 0;
   }
 
@@ -157,11 +203,68 @@ private:
   void heartbeat() noexcept
   {
     std::apply(
-      [](auto &...opt) { ((opt ? opt->heartbeat() : void()), ...); },
+      [this](auto &...opt) { ((opt ? heartbeat(*opt) : void()), ...); },
+      connections
+    );
+  }
+
+  template <typename Conn> void heartbeat(Conn &conn) noexcept
+  {
+    conn.heartbeat();
+
+    // dropped by the heartbeat (dead peer) -> reconnect
+    if (!stopping && conn.closed())
+    {
+      conn.restart();
+    }
+  }
+
+  void timeouts(std::chrono::steady_clock::time_point now) noexcept
+  {
+    std::apply(
+      [this, now](auto &...opt) { ((opt ? timeout(*opt, now) : void()), ...); },
       connections
     );
   }
 
+  template <typename Conn>
+  void timeout(Conn &conn, std::chrono::steady_clock::time_point now) noexcept
+  {
+    conn.settle();
+    conn.timeout(now);
+
+    // dropped by a deadline -> reconnect
+    if (!stopping && conn.closed())
+    {
+      conn.restart();
+    }
+  }
+
+  /** retry the paused protocols */
+  void wake_all() noexcept
+  {
+    std::apply(
+      [this](auto &...opt) { ((opt ? wake(*opt) : void()), ...); }, connections
+    );
+  }
+
+  template <typename Conn> void wake(Conn &conn) noexcept
+  {
+    if (!conn.paused())
+    {
+      return;
+    }
+
+    conn.wake();
+
+    if (!stopping && conn.closed())
+    {
+      conn.restart();
+    }
+
+    ready.push(&conn);
+  }
+
   void stop_all() noexcept
   {
     manet::log::info("stopping all connections");
@@ -182,4 +285,8 @@ using Reactor = reactor::Reactor<Net, Connections...>;
 template <typename Transport, typename Protocol>
 using ConnectionConfig = reactor::ConnectionConfig<Transport, Protocol>;
 
+using ConnectionOptions = reactor::ConnectionOptions;
+using Deadlines = reactor::Deadlines;
+using Scheduling = reactor::Scheduling;
+
 } // namespace manet
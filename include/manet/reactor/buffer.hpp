@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstring>
+
 #include "manet/utils/hexdump.hpp"
 
 namespace manet::reactor
@@ -20,20 +22,53 @@ public:
     return std::span(_buf).subspan(_wpos, CAP - _wpos);
   }
 
-  void clear() { _rpos = _wpos = 0; }
+  /** drop the unread bytes (pinned ones are not recycled, see `pin`) */
+  void clear()
+  {
+    _rpos = _wpos;
+    if (_pinned == 0)
+    {
+      _rpos = _wpos = 0;
+    }
+  }
 
   void inc_wpos(std::size_t len) { _wpos += len; }
   void inc_rpos(std::size_t len)
   {
     _rpos += len;
-    if (_rpos == _wpos)
+    if (_rpos == _wpos && _pinned == 0)
+    {
+      _rpos = _wpos = 0;
+    }
+  }
+
+  /** the next `len` bytes read stay pinned (the kernel sends them in place,
+   * see MSG_ZEROCOPY): space is only recycled once all are unpinned */
+  void pin(std::size_t len) { _pinned += len; }
+  void unpin(std::size_t len)
+  {
+    _pinned -= len;
+    if (_rpos == _wpos && _pinned == 0)
     {
       _rpos = _wpos = 0;
     }
   }
 
+  std::size_t pinned() const { return _pinned; }
+
   bool full() { return CAP == _wpos; }
 
+  /** move unread bytes to the front (frees the space of consumed bytes) */
+  void compact()
+  {
+    if (0 < _rpos)
+    {
+      std::memmove(_buf.data(), _buf.data() + _rpos, _wpos - _rpos);
+      _wpos -= _rpos;
+      _rpos = 0;
+    }
+  }
+
   std::string hexdump()
   {
     return utils::hexdump(
@@ -55,6 +90,7 @@ private:
 
   std::size_t _rpos = 0;
   std::size_t _wpos = 0;
+  std::size_t _pinned = 0;
 };
 
 } // namespace manet::reactor
@@ -1,7 +1,9 @@
 #pragma once
 
+#include <chrono>
 #include <cstring>
 #include <string>
+#include <vector>
 
 #include "manet/net/concepts.hpp"
 #include "manet/net/dial.hpp"
@@ -9,6 +11,7 @@
 #include "manet/transport/concepts.hpp"
 
 #include "manet/logging.hpp"
+#include "manet/utils/histogram.hpp"
 
 namespace manet::reactor
 {
@@ -31,9 +34,64 @@ struct BaseConnection
   virtual bool closed() const noexcept = 0;
   virtual bool done() const noexcept = 0;
 
+  // read scheduling (see Scheduling)
+  virtual bool backlogged() const noexcept = 0;
+  virtual unsigned weight() const noexcept = 0;
+  virtual void resume() noexcept = 0;
+
   virtual ~BaseConnection() = default;
 };
 
+/** Per-phase deadlines of a Connection (0: no deadline).
+ *
+ * - connect: asynchronous connect (until writeable)
+ *
+ * - transport: transport handshake (for example TLS)
+ *
+ * - protocol: protocol handshake (until `established()`, for example the
+ * WebSocket upgrade)
+ *
+ * - close: graceful protocol and transport shutdown
+ *
+ * An expired deadline drops the connection (closed), so the reactor
+ * reconnects it.
+ */
+struct Deadlines
+{
+  std::chrono::milliseconds connect{0};
+  std::chrono::milliseconds transport{0};
+  std::chrono::milliseconds protocol{0};
+  std::chrono::milliseconds close{0};
+};
+
+/** Read scheduling of a Connection.
+ *
+ * - read_budget: bytes read per event (0: until the transport runs dry). A
+ * connection that spent its budget with data left is `backlogged()`, the
+ * reactor `resume()`s it once the other connections had their turn
+ *
+ * - weight: the budget is `weight` times `read_budget`, and the reactor
+ * resumes heavier connections first (latency-critical streams)
+ */
+struct Scheduling
+{
+  std::size_t read_budget = 0;
+  unsigned weight = 1;
+};
+
+/** Per-connection options (all optional) */
+struct ConnectionOptions
+{
+  Deadlines deadlines{};
+
+  // hold protocol output back until the event is handled (one write)
+  bool cork = false;
+
+  net::SocketOptions socket_options{};
+
+  Scheduling scheduling{};
+};
+
 /**
  * Generic Connection<Net, Transport, Protocol>; edge-triggered,
  * asynchronous, non-blocking connection state machine for layers:
@@ -50,6 +108,8 @@ struct BaseConnection
  *
  * - `restart()` only takes effect when `done()`
  *
+ * - `timeout(now)` enforces the Deadlines (called by the reactor)
+ *
  * #### Machine states:
  *
  * - uninitialized (transient): reset, dial non-blocking FD, initialize
@@ -60,7 +120,8 @@ struct BaseConnection
  * - Transport: asynchronous handshake (if declared)
  *
  * - Protocol (normal operation): Reads drain RX fully and feed protocol frames
- * until exhausted, Writes drain TX fully.
+ * until exhausted, Writes drain TX fully. Once RX is empty, a protocol may
+ * redirect reads to its own buffer (see `protocol::ReadTarget`).
  *
  * - close_protocol: graceful protocol shutdown while still reading (keep
  * calling on_shutdown until Close)
@@ -90,15 +151,27 @@ public:
   using Endpoint = typename Transport::template Endpoint<Net>;
   using Session = typename Protocol::Session;
 
+  using clock = std::chrono::steady_clock;
+
+  enum class Phase : uint8_t
+  {
+    none,
+    connect,
+    transport,
+    protocol,
+    close
+  };
+
   Connection(
     const std::string &host, uint16_t port,
     typename Transport::config_t transport_config,
-    typename Protocol::config_t protocol_config
+    typename Protocol::config_t protocol_config, ConnectionOptions options = {}
   )
       : _protocol(Session{host, port, protocol_config}),
         _transport_config(std::move(transport_config)),
         _protocol_config(std::move(protocol_config)),
         _host(host),
+        _options(std::move(options)),
         _fd(-1),
         _state(state_t::uninitialized),
         _port(port)
@@ -140,21 +213,107 @@ public:
       );
     }
 
-    steps(&ev);
+    // zero-copy sends completed (error queue events come as EPOLLERR)
+    release_tx();
+
+    if (_options.cork)
+    {
+      _corked = true;
+      steps(&ev);
+      uncork();
+    }
+    else
+    {
+      steps(&ev);
+    }
   }
 
   void heartbeat() noexcept
   {
     if constexpr (protocol::HasHeartbeat<Protocol>)
     {
-      if (_state == state_t::protocol)
+      // (paused: nothing is read, the peer can not be judged by it)
+      if (_state == state_t::protocol && !_paused)
       {
-        _protocol.heartbeat(Output{&_tx});
-        transport_write();
+        switch (_protocol.heartbeat(Output{&_tx}))
+        {
+        case protocol::Status::ok:
+        case protocol::Status::pause: // (reads nothing)
+          transport_write();
+          break;
+        case protocol::Status::close:
+          // peer is unresponsive, a graceful shutdown would stall as well
+          log::warn("dropping unresponsive connection ({} {})", _fd, _host);
+          enter_closed();
+          break;
+        case protocol::Status::error:
+          enter_error();
+          break;
+        }
       }
     }
   }
 
+  /** drop the connection if its current phase exceeded its deadline
+   *
+   * @param[in] now the reactor's current time
+   */
+  void timeout(clock::time_point now) noexcept
+  {
+    auto current = phase();
+
+    // phase changed: start its clock
+    if (current != _phase)
+    {
+      _phase = current;
+
+      auto limit = deadline(current);
+      _deadline = 0 < limit.count() ? now + limit : clock::time_point::max();
+
+      return;
+    }
+
+    if (_deadline < now)
+    {
+      log::warn(
+        "{} deadline expired ({} {}:{})", to_string(_phase), _fd, _host, _port
+      );
+
+      _timed_out = _phase;
+      _phase = Phase::none;
+      _deadline = clock::time_point::max();
+
+      enter_closed();
+    }
+  }
+
+  /** the phase that timed out last (none if no deadline expired) */
+  Phase timed_out() const noexcept { return _timed_out; }
+
+  /** close the parked sockets (see `teardown`) once the kernel released
+   * their zero-copy sends, the reactor calls this every round */
+  void settle() noexcept
+  {
+    if constexpr (transport::HasRelease<Net, Transport>)
+    {
+      std::erase_if(
+        _parked,
+        [this](Parked &parked)
+        {
+          parked.transport.release(Input{&_tx});
+          if (!parked.transport.settled())
+          {
+            return false;
+          }
+
+          parked.transport.destroy();
+          Net::close(parked.fd);
+          return true;
+        }
+      );
+    }
+  }
+
   void restart() noexcept override
   {
     if (!done())
@@ -162,7 +321,14 @@ public:
 
     teardown();
 
-    _protocol = Session{_host, _port, _protocol_config};
+    if constexpr (protocol::HasReset<Protocol>)
+    {
+      _protocol.reset(_protocol_config);
+    }
+    else
+    {
+      _protocol = Session{_host, _port, _protocol_config};
+    }
 
     enter_uninitialized();
   }
@@ -191,12 +357,86 @@ public:
 
   bool closed() const noexcept override { return _state == state_t::closed; }
 
+  /** the last read stopped at the read budget with data left */
+  bool backlogged() const noexcept override
+  {
+    return _backlog && !_paused && _state == state_t::protocol;
+  }
+
+  unsigned weight() const noexcept override
+  {
+    return _options.scheduling.weight;
+  }
+
+  /** the protocol paused reading (backpressure) */
+  bool paused() const noexcept { return _paused; }
+
+  /** how long reading was paused (each pause until it was resumed) */
+  const utils::Histogram &paused_ns() const noexcept { return _paused_ns; }
+
+  /** hand the input held back by a paused protocol over again (after
+   * `Net::wake()`), reading resumes if it is taken */
+  void wake() noexcept
+  {
+    if (!_paused || _state != state_t::protocol)
+    {
+      return;
+    }
+
+    if (_options.cork)
+    {
+      _corked = true;
+      unpause();
+      uncork();
+    }
+    else
+    {
+      unpause();
+    }
+  }
+
+  /** continue reading where the read budget cut the last one short */
+  void resume() noexcept override
+  {
+    if (!backlogged())
+      return;
+
+    if (_options.cork)
+    {
+      _corked = true;
+      read_protocol();
+      uncork();
+    }
+    else
+    {
+      read_protocol();
+    }
+  }
+
   bool done() const noexcept override
   {
     return _state == state_t::error || _state == state_t::closed;
   }
 
-  ~Connection() override { teardown(); }
+  ~Connection() override
+  {
+    teardown();
+
+    if constexpr (transport::HasRelease<Net, Transport>)
+    {
+      // TX goes away with the connection, the sends still in flight with it
+      for (auto &parked : _parked)
+      {
+        if (!parked.transport.settled())
+        {
+          log::warn("zero-copy sends in flight at exit ({})", parked.fd);
+        }
+
+        parked.transport.destroy();
+        Net::close(parked.fd);
+      }
+    }
+  }
 
   Connection(const Connection &) = delete;
   Connection &operator=(const Connection &) = delete;
@@ -217,6 +457,23 @@ private:
     error
   };
 
+  static constexpr std::string_view to_string(Phase phase)
+  {
+    switch (phase)
+    {
+    case Phase::connect:
+      return "connect";
+    case Phase::transport:
+      return "transport";
+    case Phase::protocol:
+      return "protocol";
+    case Phase::close:
+      return "close";
+    default:
+      return "none";
+    }
+  }
+
   static constexpr std::string_view to_string(state_t state)
   {
     switch (state)
@@ -248,19 +505,102 @@ private:
   Buffer<RX_CAP> _rx;
   Buffer<TX_CAP> _tx;
 
+  // bytes the transport received in place (while set the protocol reads these
+  // instead of RX, see `RxSink::mapped`)
+  std::span<const std::byte> *_view = nullptr;
+
   Endpoint _transport;
   Session _protocol;
 
+  // earlier sockets the kernel may still send pinned TX bytes from
+  struct Parked
+  {
+    typename Net::fd_t fd;
+    Endpoint transport;
+  };
+  std::vector<Parked> _parked;
+
   typename Transport::config_t _transport_config;
   typename Protocol::config_t _protocol_config;
 
   const std::string _host;
+  const ConnectionOptions _options;
   void *_cookie = nullptr;
 
+  // bytes left to read for this event (the reactor resumes a backlog)
+  std::size_t _budget = SIZE_MAX;
+  bool _backlog = false;
+
+  // the protocol paused reading (since `_paused_at`) until woken
+  bool _paused = false;
+  clock::time_point _paused_at{};
+  utils::Histogram _paused_ns;
+
+  clock::time_point _deadline = clock::time_point::max();
+
+  Phase _phase = Phase::none;
+  Phase _timed_out = Phase::none;
+
+  // corking (`ConnectionOptions::cork`): while an event is handled protocol
+  // output only accumulates in TX (`_pending`), `uncork` flushes it with a
+  // single transport write
+  bool _corked = false;
+  bool _pending = false;
+
+  // 0-RTT: on_connect ran before the handshake, `_early` bytes of TX are sent
+  // as early data (consumed once the peer accepted them)
+  std::size_t _early = 0;
+  bool _early_connect = false;
+
   typename Net::fd_t _fd;
   state_t _state;
   uint16_t _port;
 
+  Phase phase() const noexcept
+  {
+    switch (_state)
+    {
+    case state_t::in_progress:
+      return Phase::connect;
+    case state_t::transport:
+      return Phase::transport;
+    case state_t::protocol:
+    {
+      if constexpr (protocol::HasEstablished<Protocol>)
+      {
+        if (!_protocol.established())
+        {
+          return Phase::protocol;
+        }
+      }
+      return Phase::none;
+    }
+    case state_t::close_protocol:
+    case state_t::drain_protocol:
+    case state_t::close_transport:
+      return Phase::close;
+    default:
+      return Phase::none;
+    }
+  }
+
+  std::chrono::milliseconds deadline(Phase phase) const noexcept
+  {
+    switch (phase)
+    {
+    case Phase::connect:
+      return _options.deadlines.connect;
+    case Phase::transport:
+      return _options.deadlines.transport;
+    case Phase::protocol:
+      return _options.deadlines.protocol;
+    case Phase::close:
+      return _options.deadlines.close;
+    default:
+      return std::chrono::milliseconds{0};
+    }
+  }
+
   void steps(typename Net::event_t *ev) noexcept
   {
     while (true)
@@ -326,7 +666,19 @@ private:
     _rx.clear();
     _tx.clear();
 
-    net::DialResult<Net> result = net::dial<Net>(_host.c_str(), _port);
+    _early = 0;
+    _early_connect = false;
+
+    _paused = false;
+    _paused_at = {};
+
+    // a new attempt: its phases are timed from scratch (the next `timeout`
+    // starts the clock, even if the last attempt failed in the same phase)
+    _phase = Phase::none;
+    _deadline = clock::time_point::max();
+
+    net::DialResult<Net> result =
+      net::dial<Net>(_host.c_str(), _port, _options.socket_options);
 
     if (result.fd == -1)
     {
@@ -385,6 +737,15 @@ private:
     {
       // let step_Transport continue
       _state = state_t::transport;
+
+      if constexpr (transport::HasEarlyData<Net, Transport> &&
+                    protocol::HasConnectHandler<Protocol>)
+      {
+        if (_transport.early_data())
+        {
+          enter_early_data();
+        }
+      }
     }
     else
     {
@@ -400,6 +761,29 @@ private:
   {
     _state = state_t::protocol;
 
+    if constexpr (transport::HasEarlyData<Net, Transport>)
+    {
+      if (_early_connect)
+      {
+        // on_connect already ran: drop what the peer accepted, TX still holds
+        // all of it otherwise (resent below)
+        if (_transport.early_accepted())
+        {
+          _tx.inc_rpos(_early);
+        }
+        else
+        {
+          log::info("early data rejected, resending ({} {})", _fd, _host);
+        }
+
+        _early = 0;
+        _early_connect = false;
+
+        transport_write();
+        return;
+      }
+    }
+
     if constexpr (protocol::HasConnectHandler<Protocol>)
     {
       bind_protocol<&Session::on_connect>();
@@ -410,6 +794,22 @@ private:
     }
   }
 
+  /** 0-RTT: the protocol connects before the handshake completes, its
+   * output (still in TX) is sent as early data by step_Transport
+   */
+  void enter_early_data() noexcept
+  {
+    if (_protocol.on_connect(IO{Input{&_rx, _view}, Output{&_tx}}) !=
+        protocol::Status::ok)
+    {
+      enter_error();
+      return;
+    }
+
+    _early = 0;
+    _early_connect = true;
+  }
+
   void enter_close_protocol() noexcept
   {
     if constexpr (protocol::HasShutdown<Protocol>)
@@ -418,18 +818,19 @@ private:
 
       while (true)
       {
-        auto before = _rx.rbuf().size();
+        auto before = rx_pending();
 
-        switch (_protocol.on_shutdown(IO{Input{&_rx}, Output{&_tx}}))
+        switch (_protocol.on_shutdown(IO{Input{&_rx, _view}, Output{&_tx}}))
         {
         case protocol::Status::ok:
+        case protocol::Status::pause: // (no progress)
         {
           transport_write();
           if (_state != state_t::close_protocol)
           {
             return;
           } // done/error
-          if (before <= _rx.rbuf().size())
+          if (before <= rx_pending())
           {
             return;
           } // no progress
@@ -511,6 +912,14 @@ private:
     // state is skipped)
     if constexpr (transport::HasHandshake<Net, Transport>)
     {
+      if constexpr (transport::HasEarlyData<Net, Transport>)
+      {
+        if (_early_connect && !early_write())
+        {
+          return;
+        }
+      }
+
       transport::Status status = _transport.handshake_step();
       if (status == transport::Status::ok)
       {
@@ -527,12 +936,40 @@ private:
     }
   }
 
+  /** send TX (without consuming it) as early data, true once all is sent */
+  bool early_write() noexcept
+    requires transport::HasEarlyData<Net, Transport>
+  {
+    while (_early < _tx.rbuf().size())
+    {
+      std::size_t written = 0;
+
+      transport::Status status =
+        _transport.early_write(_tx.rbuf().subspan(_early), written);
+      if (status != transport::Status::ok)
+      {
+        arm(status);
+        return false;
+      }
+
+      _early += written;
+    }
+
+    return true;
+  }
+
+  /** unread protocol input */
+  std::size_t rx_pending() noexcept
+  {
+    return _view ? _view->size() : _rx.rbuf().size();
+  }
+
   void protocol_consume() noexcept
   {
     while (true)
     {
       // attempt reading a frame:
-      auto before = _rx.rbuf().size();
+      auto before = rx_pending();
       if (before == 0)
       {
         return;
@@ -540,33 +977,52 @@ private:
 
       bind_protocol<&Session::on_data>();
 
-      // protocol layer changed state -> done
-      if (_state != state_t::protocol)
+      // protocol layer changed state or paused -> done
+      if (_state != state_t::protocol || _paused)
       {
         return;
       }
 
       // no progress -> done
-      if (before <= _rx.rbuf().size())
+      if (before <= rx_pending())
       {
         return;
       }
     }
   }
 
+  void read_protocol() noexcept
+  {
+    _backlog = false;
+    auto &scheduling = _options.scheduling;
+    _budget = scheduling.read_budget > 0
+                ? scheduling.read_budget * scheduling.weight
+                : SIZE_MAX;
+
+    // keep reading form Transport while protocol stays in Protocol state
+    transport_read(
+      [this]()
+      {
+        protocol_consume();
+        return _state == state_t::protocol && !_paused;
+      },
+      [this]() { enter_close_transport(); }
+    );
+
+    // the kernel drops back to delayed ACKs
+    if (_options.socket_options.quickack && _fd != -1)
+    {
+      int on = 1;
+      Net::setsockopt(_fd, IPPROTO_TCP, TCP_QUICKACK, &on, sizeof(on));
+    }
+  }
+
   void step_Protocol(typename Net::event_t &ev) noexcept
   {
-    if (Net::ev_readable(ev))
+    // (paused: the data waits in the socket)
+    if (Net::ev_readable(ev) && !_paused)
     {
-      // keep reading form Transport while protocol stays in Protocol state
-      transport_read(
-        [this]()
-        {
-          protocol_consume();
-          return _state == state_t::protocol;
-        },
-        [this]() { enter_close_transport(); }
-      );
+      read_protocol();
     }
 
     if (Net::ev_writeable(ev))
@@ -589,11 +1045,14 @@ private:
             // call `on_shutdown` repeatedly in case of multiple frames
             while (true)
             {
-              auto before = _rx.rbuf().size();
+              auto before = rx_pending();
 
-              switch (_protocol.on_shutdown(IO{Input{&_rx}, Output{&_tx}}))
+              switch (
+                _protocol.on_shutdown(IO{Input{&_rx, _view}, Output{&_tx}})
+              )
               {
               case protocol::Status::ok:
+              case protocol::Status::pause: // (no progress)
                 transport_write();
                 // early done:
                 if (_state != state_t::close_protocol)
@@ -601,7 +1060,7 @@ private:
                   return false;
                 }
                 // no progress -> arm(..)
-                if (before <= _rx.rbuf().size())
+                if (before <= rx_pending())
                 {
                   return true;
                 }
@@ -697,15 +1156,40 @@ private:
     }
   }
 
+  /** write protocol output now, or once uncorked (unless TX fills up) */
+  void protocol_write() noexcept
+  {
+    if (_corked && _tx.rbuf().size() < TX_CAP / 2)
+    {
+      _pending = true;
+      return;
+    }
+
+    transport_write();
+  }
+
+  void uncork() noexcept
+  {
+    _corked = false;
+
+    if (_pending &&
+        (_state == state_t::protocol || _state == state_t::close_protocol))
+    {
+      transport_write();
+    }
+
+    _pending = false;
+  }
+
   // always called when _state == Protocol
   template <protocol::Status (Session::*Handler)(IO) noexcept>
   void bind_protocol() noexcept
   {
-    switch ((_protocol.*Handler)(IO{Input{&_rx}, Output{&_tx}}))
+    switch ((_protocol.*Handler)(IO{Input{&_rx, _view}, Output{&_tx}}))
     {
     case protocol::Status::ok:
     {
-      transport_write();
+      protocol_write();
       break;
     }
     case protocol::Status::close:
@@ -741,13 +1225,69 @@ private:
       enter_error();
       break;
     }
+    case protocol::Status::pause:
+    {
+      if (!_paused)
+      {
+        _paused = true;
+        log::trace("protocol paused reading ({} {})", _fd, _host);
+      }
+
+      if (_paused_at == clock::time_point{})
+      {
+        _paused_at = clock::now();
+      }
+
+      protocol_write();
+      break;
+    }
     }
   }
 
+  /** retry the paused protocol, then read what queued up in the meantime */
+  void unpause() noexcept
+  {
+    _paused = false;
+
+    // (also hands over input the protocol keeps outside of RX)
+    bind_protocol<&Session::on_data>();
+
+    if (_state == state_t::protocol && !_paused)
+    {
+      protocol_consume();
+    }
+
+    if (_state != state_t::protocol || _paused)
+    {
+      return;
+    }
+
+    auto paused = clock::now() - _paused_at;
+    _paused_ns.record(static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(paused).count()
+    ));
+    _paused_at = {};
+
+    log::trace("protocol resumed reading ({} {})", _fd, _host);
+
+    if constexpr (protocol::HasResume<Protocol>)
+    {
+      _protocol.on_resume();
+    }
+
+    read_protocol();
+  }
+
   void transport_read(auto &&consume, auto &&on_close) noexcept
   {
     while (true)
     {
+      if (_rx.full())
+      {
+        // a partial frame at the end of RX: reclaim consumed space
+        _rx.compact();
+      }
+
       if (_rx.full())
       {
         log::trace("rx_buf({}):\n{}", _fd, _rx.hexdump());
@@ -756,11 +1296,49 @@ private:
         return;
       }
 
+      // the protocol may ask for the payload tail of a large frame to bypass
+      // RX (only once RX is drained, so bytes are never reordered)
+      ReadTarget *target = nullptr;
+
+      if constexpr (protocol::HasReadTarget<Protocol>)
+      {
+        if (_state == state_t::protocol && _rx.rbuf().empty())
+        {
+          target = _protocol.read_target();
+        }
+      }
+
+      // with RX drained the transport may also hand out bytes in place
+      std::span<const std::byte> mapped;
+      bool offer = _state == state_t::protocol && _rx.rbuf().empty() &&
+                   !target;
+
       auto before = _rx.rbuf().size();
-      transport::Status st = _transport.read(Output{&_rx});
+      auto landed = target ? target->len : 0;
+
+      transport::Status st = _transport.read(
+        RxSink{&_rx, target, offer ? &mapped : nullptr}
+      );
       auto after = _rx.rbuf().size();
 
-      if (after != before)
+      std::size_t received =
+        after - before + mapped.size() + (target ? target->len - landed : 0);
+
+      if (!mapped.empty())
+      {
+        if (!consume_mapped(mapped, consume))
+          return;
+      }
+      else if (target && target->len != landed)
+      {
+        bind_protocol<&Session::on_data>();
+
+        if (_state != state_t::protocol || _paused)
+        {
+          return;
+        }
+      }
+      else if (after != before)
       {
         if (!consume())
           return; // no progress
@@ -769,6 +1347,15 @@ private:
       switch (st)
       {
       case transport::Status::ok:
+        _budget -= std::min(_budget, received);
+
+        if (_budget == 0 && _state == state_t::protocol)
+        {
+          // budget spent: the reactor resumes us after the others
+          _backlog = true;
+          return;
+        }
+
         // keep draining until want_read/close/error
         continue;
 
@@ -789,8 +1376,52 @@ private:
     }
   }
 
+  /** let the protocol parse received bytes in place, what it leaves (a
+   * partial frame) is kept in RX */
+  bool
+  consume_mapped(std::span<const std::byte> &mapped, auto &&consume) noexcept
+  {
+    _view = &mapped;
+    bool more = consume();
+    _view = nullptr;
+
+    if (mapped.empty() || _state == state_t::error ||
+        _state == state_t::closed)
+    {
+      return more;
+    }
+
+    if (_rx.wbuf().size() < mapped.size())
+    {
+      log::error("rx buffer overflow ({} {})", _fd, RX_CAP);
+      enter_error();
+      return false;
+    }
+
+    std::memcpy(_rx.wbuf().data(), mapped.data(), mapped.size());
+    _rx.inc_wpos(mapped.size());
+
+    return more;
+  }
+
+  /** hand TX space the kernel no longer sends from back */
+  void release_tx() noexcept
+  {
+    if constexpr (transport::HasRelease<Net, Transport>)
+    {
+      if (_fd != -1 && _tx.pinned() > 0)
+      {
+        _transport.release(Input{&_tx});
+      }
+
+      settle();
+    }
+  }
+
   bool transport_write(bool re_arm = true) noexcept
   {
+    release_tx();
+
     while (_fd != -1 && !_tx.rbuf().empty())
     {
       auto before = _tx.rbuf().size();
@@ -835,6 +1466,24 @@ private:
         _protocol.teardown();
       }
 
+      if constexpr (transport::HasRelease<Net, Transport>)
+      {
+        // TX is reused by the next connection while the kernel may still
+        // send from it: keep the socket (a closed one reports no more
+        // completions) until `settle` sees its pinned bytes released
+        release_tx();
+        if (!_transport.settled())
+        {
+          log::info("parking socket with zero-copy sends in flight ({})", _fd);
+
+          Net::clear(_fd);
+          _parked.push_back({_fd, std::move(_transport)});
+
+          _fd = -1;
+          return;
+        }
+      }
+
       _transport.destroy();
 
       Net::clear(_fd);
@@ -8,11 +8,33 @@ namespace manet::reactor
 static constexpr std::size_t RX_CAP = 1 << 20;
 static constexpr std::size_t TX_CAP = 1 << 20;
 
+/** bytes for the protocol: the unread part of a buffer, or a `view` of bytes
+ * the transport handed out in place (see `RxSink::mapped`) */
 template <std::size_t CAP> struct Input
 {
   Buffer<CAP> *rx;
-  auto rbuf() const { return rx->rbuf(); }
-  void read(std::size_t len) { rx->inc_rpos(len); }
+  std::span<const std::byte> *view = nullptr;
+
+  std::span<const std::byte> rbuf() const
+  {
+    return view ? *view : rx->rbuf();
+  }
+
+  void read(std::size_t len)
+  {
+    if (view)
+    {
+      *view = view->subspan(len);
+    }
+    else
+    {
+      rx->inc_rpos(len);
+    }
+  }
+
+  // zero-copy send: pin bytes before reading them (see `Buffer::pin`)
+  void pin(std::size_t len) { rx->pin(len); }
+  void unpin(std::size_t len) { rx->unpin(len); }
 };
 
 template <std::size_t CAP> struct Output
@@ -22,8 +44,45 @@ template <std::size_t CAP> struct Output
   void wrote(std::size_t len) { tx->inc_wpos(len); }
 };
 
+/** destination for payload bytes that bypass RX (see protocol::ReadTarget) */
+struct ReadTarget
+{
+  std::span<std::byte> buf; // where the protocol wants the next bytes
+  std::size_t len = 0;      // bytes that landed in `buf` so far
+};
+
+/** transport reads land in RX, or straight in `target` if the protocol asked
+ * for it.
+ *
+ * A transport that receives in place (without copying) may instead point
+ * `*mapped` at the received bytes, they stay valid until its next `read`.
+ * This is only offered while RX is empty.
+ */
+struct RxSink
+{
+  Buffer<RX_CAP> *rx;
+  ReadTarget *target = nullptr;
+  std::span<const std::byte> *mapped = nullptr;
+
+  std::span<std::byte> wbuf() const
+  {
+    return target ? target->buf.subspan(target->len) : rx->wbuf();
+  }
+
+  void wrote(std::size_t len)
+  {
+    if (target)
+    {
+      target->len += len;
+    }
+    else
+    {
+      rx->inc_wpos(len);
+    }
+  }
+};
+
 using RxSource = Input<RX_CAP>;
-using RxSink = Output<RX_CAP>;
 
 using TxSource = Input<TX_CAP>;
 using TxSink = Output<TX_CAP>;
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+#include "connection.hpp"
+
+namespace manet::reactor
+{
+
+/** Connections that spent their read budget with data left (backlogged).
+ *
+ * Ordered by weight (heaviest first), first come first served within a
+ * weight. A connection is queued at most once.
+ *
+ * `resume` gives every queued connection one more budget, in order. Who is
+ * still backlogged afterwards queues up again, behind the connections that
+ * were handled by the poll loop in the meantime.
+ *
+ * @tparam N capacity (the number of connections)
+ */
+template <typename Net, std::size_t N> class ReadyList
+{
+public:
+  using conn_t = BaseConnection<Net>;
+
+  bool empty() const noexcept { return _size == 0; }
+  std::size_t size() const noexcept { return _size; }
+
+  /** queue `conn` if it is backlogged */
+  void push(conn_t *conn) noexcept
+  {
+    if (!conn->backlogged() || _size == N)
+    {
+      return;
+    }
+
+    for (std::size_t i = 0; i < _size; i++)
+    {
+      if (_conns[i] == conn)
+      {
+        return;
+      }
+    }
+
+    // behind every connection of at least the same weight
+    std::size_t at = _size;
+    while (at > 0 && _conns[at - 1]->weight() < conn->weight())
+    {
+      _conns[at] = _conns[at - 1];
+      at--;
+    }
+
+    _conns[at] = conn;
+    _size++;
+  }
+
+  /** resume each queued connection once, `then(conn)` after each */
+  template <typename F> void resume(F &&then) noexcept
+  {
+    std::array<conn_t *, N> turn = _conns;
+    std::size_t len = _size;
+    _size = 0;
+
+    for (std::size_t i = 0; i < len; i++)
+    {
+      conn_t *conn = turn[i];
+
+      if (!conn->backlogged())
+      {
+        continue;
+      }
+
+      conn->resume();
+      then(conn);
+      push(conn);
+    }
+  }
+
+private:
+  std::array<conn_t *, N> _conns{};
+  std::size_t _size = 0;
+};
+
+} // namespace manet::reactor
@@ -1,7 +1,9 @@
 #pragma once
 
 #include <concepts>
+#include <cstddef>
 #include <optional>
+#include <span>
 
 #include "manet/reactor/io.hpp"
 #include "manet/transport/status.hpp"
@@ -27,6 +29,43 @@ concept Shutdown = requires(typename T::template Endpoint<Net> &ctx) {
   { ctx.shutdown_step() } -> std::same_as<transport::Status>;
 };
 
+/** optional TLS 1.3 style early data (0-RTT) before the handshake completes
+ *
+ * - early_data: the endpoint can send early data on this connection
+ * - early_write: send (part of) `data` as early data, sets `written`
+ * - early_accepted: after the handshake, whether the peer accepted it
+ *   (otw. everything sent early must be sent again)
+ */
+template <typename Net, typename T>
+concept HasEarlyData =
+  requires { (void)&T::template Endpoint<Net>::early_write; };
+
+template <typename Net, typename T>
+concept EarlyData = requires(
+  typename T::template Endpoint<Net> &ctx, std::span<const std::byte> data,
+  std::size_t &written
+) {
+  { ctx.early_data() } noexcept -> std::same_as<bool>;
+  { ctx.early_write(data, written) } noexcept -> std::same_as<Status>;
+  { ctx.early_accepted() } noexcept -> std::same_as<bool>;
+};
+
+/** optional zero-copy send: `write` may pin the bytes it consumes (see
+ * `Buffer::pin`), `release` unpins the ones the kernel is done with.
+ * `settled` once nothing is pinned: the socket is only closed then (the
+ * completions are reported on it), until then the connection parks it
+ */
+template <typename Net, typename T>
+concept HasRelease = requires { (void)&T::template Endpoint<Net>::release; };
+
+template <typename Net, typename T>
+concept Release = requires(
+  typename T::template Endpoint<Net> &ctx, manet::reactor::TxSource out
+) {
+  { ctx.release(out) } noexcept -> std::same_as<void>;
+  { ctx.settled() } noexcept -> std::same_as<bool>;
+};
+
 template <typename Net, typename T>
 concept Transport =
   requires(
@@ -43,6 +82,8 @@ concept Transport =
     { ctx.destroy() } noexcept -> std::same_as<void>;
   } &&
   (!HasHandshake<Net, T> || Handshake<Net, T>) &&
-  (!HasShutdown<Net, T> || Shutdown<Net, T>);
+  (!HasShutdown<Net, T> || Shutdown<Net, T>) &&
+  (!HasEarlyData<Net, T> || (HasHandshake<Net, T> && EarlyData<Net, T>)) &&
+  (!HasRelease<Net, T> || Release<Net, T>);
 
 } // namespace manet::transport
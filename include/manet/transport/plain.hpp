@@ -1,17 +1,44 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <linux/errqueue.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <optional>
-#include <variant>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <unistd.h>
 
+#include "manet/logging.hpp"
+#include "manet/net/concepts.hpp"
 #include "manet/reactor/io.hpp"
 #include "status.hpp"
 
 namespace manet::transport
 {
 
+/** plain transport setup (`Plain::config_t`) */
+struct PlainConfig
+{
+  // receive by mapping up to this many bytes of socket pages instead of
+  // copying them (TCP_ZEROCOPY_RECEIVE, kernel sockets only), 0: copy
+  std::size_t zerocopy_receive = 0;
+
+  // send with MSG_ZEROCOPY once this many bytes are queued (the kernel pins
+  // the pages instead of copying, it pays off from ~10KB), 0: copy
+  std::size_t zerocopy_send = 0;
+
+  // a read that returns less than RX could take drained the socket: report
+  // want_read right away instead of reading again until EAGAIN (re-arming
+  // the subscription reports data that arrived in between)
+  bool short_read_drained = false;
+};
+
 struct Plain
 {
-  using config_t = std::monostate;
+  using config_t = PlainConfig;
 
   template <typename Net> struct Endpoint
   {
@@ -22,25 +49,115 @@ struct Plain
     ssize_t (*net_read)(fd_t, void *, std::size_t) noexcept;
     ssize_t (*net_write)(fd_t, const void *, std::size_t) noexcept;
 
-    static std::optional<Endpoint> init(fd_t fd, config_t) noexcept
+    // zero-copy receive: the socket's mapping (received pages are placed in
+    // it, whatever does not fill a page is copied)
+    const std::byte *region = nullptr;
+    std::size_t region_len = 0;
+
+    // zero-copy send: bytes of the sends the kernel has not released yet (it
+    // numbers the sends, TCP releases them in order)
+    static constexpr std::size_t ZC_SENDS = 64;
+
+    std::size_t zc_threshold = 0;
+    std::array<std::uint32_t, ZC_SENDS> zc_lens{};
+    std::uint32_t zc_sent = 0;
+    std::uint32_t zc_done = 0;
+
+    bool short_read_drained = false;
+
+    static std::optional<Endpoint> init(fd_t fd, config_t config) noexcept
     {
-      return Endpoint{
+      Endpoint endpoint{
         .fd = fd,
         .net_read = +[](fd_t fd, void *ptr, std::size_t n) noexcept
                     { return Net::read(fd, ptr, n); },
         .net_write = +[](fd_t fd, const void *ptr, std::size_t n) noexcept
-                     { return Net::write(fd, ptr, n); }
+                     { return Net::write(fd, ptr, n); },
+        .short_read_drained = config.short_read_drained
       };
+
+      if constexpr (net::KernelSockets<Net>)
+      {
+        if (config.zerocopy_receive > 0)
+        {
+          endpoint.map(config.zerocopy_receive);
+        }
+
+        int one = 1;
+        if (config.zerocopy_send > 0 &&
+            ::setsockopt(fd, SOL_SOCKET, SO_ZEROCOPY, &one, sizeof(one)) == 0)
+        {
+          endpoint.zc_threshold = config.zerocopy_send;
+        }
+        else if (config.zerocopy_send > 0)
+        {
+          log::warn("zero-copy send unavailable ({} errno={})", fd, errno);
+        }
+      }
+
+      return endpoint;
     }
 
     Status read(reactor::RxSink rx) noexcept
     {
+      std::size_t limit = rx.wbuf().size();
+
+      // the Net received into a buffer already: hand that out
+      if constexpr (net::LendsBuffers<Net>)
+      {
+        if (rx.mapped)
+        {
+          return lend(rx);
+        }
+      }
+
+      if constexpr (net::KernelSockets<Net>)
+      {
+        if (region && rx.mapped)
+        {
+          tcp_zerocopy_receive zc{};
+          zc.address = reinterpret_cast<std::uintptr_t>(region);
+          zc.length = region_len;
+
+          socklen_t zc_len = sizeof(zc);
+          if (Net::getsockopt(
+                fd, IPPROTO_TCP, TCP_ZEROCOPY_RECEIVE, &zc, &zc_len
+              ) == 0)
+          {
+            if (zc.length > 0)
+            {
+              *rx.mapped = {region, zc.length};
+              return Status::ok;
+            }
+
+            // less than a page (or the head of an unaligned skb) is queued:
+            // copy exactly that, the pages after it can be mapped again
+            if (zc.recv_skip_hint > 0)
+            {
+              limit = std::min<std::size_t>(limit, zc.recv_skip_hint);
+            }
+          }
+          else if (errno != EAGAIN && errno != EINTR)
+          {
+            log::warn("zero-copy receive disabled ({} errno={})", fd, errno);
+            unmap();
+          }
+        }
+      }
+
       while (true)
       {
-        ssize_t len = net_read(fd, rx.wbuf().data(), rx.wbuf().size());
+        ssize_t len = net_read(fd, rx.wbuf().data(), limit);
         if (len > 0)
         {
           rx.wrote(len);
+
+          // (saves the read failing with EAGAIN per edge)
+          if (short_read_drained && static_cast<std::size_t>(len) < limit)
+          {
+            return Status::want_read;
+          }
+
           return Status::ok;
         }
 
@@ -65,6 +182,19 @@ struct Plain
 
     Status write(reactor::TxSource tx) noexcept
     {
+      if constexpr (net::KernelSockets<Net>)
+      {
+        if (zc_threshold > 0 && tx.rbuf().size() >= zc_threshold &&
+            zc_sent - zc_done < ZC_SENDS)
+        {
+          auto st = send_zerocopy(tx);
+          if (st)
+          {
+            return *st;
+          }
+        }
+      }
+
       while (true)
       {
         int len = net_write(fd, tx.rbuf().data(), tx.rbuf().size());
@@ -88,7 +218,139 @@ struct Plain
       }
     }
 
-    void destroy() noexcept {} // no-op
+    /** unpin the bytes of completed zero-copy sends (the kernel reports them
+     * on the socket's error queue) */
+    void release(reactor::TxSource tx) noexcept
+    {
+      while (zc_sent != zc_done)
+      {
+        alignas(cmsghdr) char control[128];
+
+        msghdr msg{};
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+
+        if (::recvmsg(fd, &msg, MSG_ERRQUEUE | MSG_DONTWAIT) < 0)
+        {
+          return; // still in flight
+        }
+
+        for (auto *cm = CMSG_FIRSTHDR(&msg); cm; cm = CMSG_NXTHDR(&msg, cm))
+        {
+          if (!(cm->cmsg_level == SOL_IP && cm->cmsg_type == IP_RECVERR) &&
+              !(cm->cmsg_level == SOL_IPV6 && cm->cmsg_type == IPV6_RECVERR))
+          {
+            continue;
+          }
+
+          auto *err = reinterpret_cast<sock_extended_err *>(CMSG_DATA(cm));
+          if (err->ee_errno != 0 || err->ee_origin != SO_EE_ORIGIN_ZEROCOPY)
+          {
+            continue;
+          }
+
+          // sends [ee_info, ee_data] are done
+          while (static_cast<std::int32_t>(err->ee_data + 1 - zc_done) > 0)
+          {
+            tx.unpin(zc_lens[zc_done++ % ZC_SENDS]);
+          }
+        }
+      }
+    }
+
+    /** the kernel released all zero-copy sends (the socket may be closed) */
+    bool settled() const noexcept { return zc_sent == zc_done; }
+
+    void destroy() noexcept { unmap(); }
+
+  private:
+    Status lend(reactor::RxSink rx) noexcept
+    {
+      ssize_t len = Net::lend(fd, *rx.mapped);
+      if (len > 0)
+      {
+        return Status::ok;
+      }
+
+      if (len == 0)
+      {
+        return Status::close;
+      }
+
+      if (errno == EAGAIN || errno == EWOULDBLOCK)
+      {
+        return Status::want_read;
+      }
+
+      return Status::error;
+    }
+
+    /** nullopt: send a copy instead */
+    std::optional<Status> send_zerocopy(reactor::TxSource tx) noexcept
+    {
+      while (true)
+      {
+        auto buf = tx.rbuf();
+
+        ssize_t len = ::send(fd, buf.data(), buf.size(), MSG_ZEROCOPY);
+        if (len >= 0)
+        {
+          // pinned until released (whatever got sent is one send)
+          if (len > 0)
+          {
+            zc_lens[zc_sent++ % ZC_SENDS] = len;
+            tx.pin(len);
+          }
+
+          tx.read(len);
+          return Status::ok;
+        }
+
+        if (errno == EAGAIN || errno == EWOULDBLOCK)
+        {
+          return Status::want_write;
+        }
+
+        if (errno == EINTR)
+        {
+          continue;
+        }
+
+        if (errno == ENOBUFS)
+        {
+          return std::nullopt; // out of memory for pinned pages
+        }
+
+        return Status::error;
+      }
+    }
+
+    void map(std::size_t len) noexcept
+    {
+      // whole pages, no more than RX would hold
+      auto page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+      len = std::min((len + page - 1) / page * page, reactor::RX_CAP);
+
+      void *ptr = ::mmap(nullptr, len, PROT_READ, MAP_SHARED, fd, 0);
+      if (ptr == MAP_FAILED)
+      {
+        log::warn("zero-copy receive unavailable ({} errno={})", fd, errno);
+        return;
+      }
+
+      region = static_cast<const std::byte *>(ptr);
+      region_len = len;
+    }
+
+    void unmap() noexcept
+    {
+      if (region)
+      {
+        ::munmap(const_cast<std::byte *>(region), region_len);
+        region = nullptr;
+        region_len = 0;
+      }
+    }
   };
 };
 
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <chrono>
+#include <cstddef>
+#include <span>
 #include <openssl/bio.h>
 #include <openssl/err.h>
 #include <openssl/ssl.h>
@@ -21,8 +24,33 @@ namespace detail
 struct TlsEndpoint
 {
   SSL *ssl_ctx;
+  const char *host;
+  int fd;
+  bool early = false; // early data enabled (TlsConfig::early_data)
+
+  // pool the SSL is returned to on destroy (its Net's BIO), nullptr: freed
+  const BIO_METHOD *pool = nullptr;
+
+  std::size_t max_write = 0; // per SSL_write (0: no limit)
+
+  bool short_read_drained = false; // TlsConfig::short_read_drained
+
+  // kernel TLS installed after the handshake: application data bypasses SSL
+  bool ktls_tx = false;
+  bool ktls_rx = false;
+
+  std::chrono::steady_clock::time_point handshake_start{};
+
+  // an operation returned Status::error: the session is not kept on destroy
+  bool failed = false;
 
   Status handshake_step() noexcept;
+
+  bool early_data() const noexcept;
+  Status
+  early_write(std::span<const std::byte> data, std::size_t &written) noexcept;
+  bool early_accepted() const noexcept;
+
   Status read(reactor::RxSink rx) noexcept;
   Status write(reactor::TxSource tx) noexcept;
   Status shutdown_step() noexcept;
@@ -31,20 +59,83 @@ struct TlsEndpoint
 
 } // namespace detail
 
-/** assumed to be used with single Net (such as PosixNet, or FStackNet) */
+/** TLS over any Net (such as Epoll, IoUring or FStack) */
 struct Tls
 {
-  using config_t = const char *;
+  using config_t = TlsConfig;
 
   template <typename Net> struct Endpoint : detail::TlsEndpoint
   {
     using fd_t = typename Net::fd_t;
 
-    static std::optional<Endpoint> init(fd_t fd, config_t host) noexcept
+    static std::optional<Endpoint>
+    init(fd_t fd, const config_t &config) noexcept
     {
       detail::g_tls_init<Net>();
 
-      auto ctx = SSL_new(detail::g_tls_ctx);
+      SSL_CTX *shared = detail::context(config);
+      if (!shared)
+      {
+        return {};
+      }
+
+      const char *host = config.host;
+
+      SSL *ctx = reusable ? detail::acquire_ssl(shared, method(), host)
+                          : nullptr;
+      if (ctx)
+      {
+        // BIO, SNI and host verification survived SSL_clear
+        BIO_set_fd(SSL_get_rbio(ctx), fd, BIO_NOCLOSE);
+        SSL_set_connect_state(ctx);
+        stats().ssl_reused++;
+      }
+      else
+      {
+        ctx = create(shared, fd, host);
+        if (!ctx)
+        {
+          return {};
+        }
+        stats().ssl_new++;
+      }
+
+      if (detail::resume_session(ctx, host, config.port))
+      {
+        log::trace("TLS resuming session ({})", host);
+      }
+
+      // fill whole records (a smaller limit is a single short record)
+      std::size_t max_write = config.max_write;
+      if (SSL3_RT_MAX_PLAIN_LENGTH < max_write)
+      {
+        max_write -= max_write % SSL3_RT_MAX_PLAIN_LENGTH;
+      }
+
+      return Endpoint{
+        {.ssl_ctx = ctx,
+         .host = host,
+         .fd = fd,
+         .early = config.early_data,
+         .pool = reusable ? method() : nullptr,
+         .max_write = max_write,
+         .short_read_drained = config.short_read_drained}
+      };
+    }
+
+  private:
+    // kTLS binds OpenSSL's socket BIO to its socket for good: no reuse
+    static constexpr bool reusable =
+      !(detail::ktls_enabled && net::KernelSockets<Net>);
+
+    static const BIO_METHOD *method() noexcept
+    {
+      return detail::BIO_method<Net>();
+    }
+
+    static SSL *create(SSL_CTX *shared, fd_t fd, const char *host) noexcept
+    {
+      SSL *ctx = SSL_new(shared);
       if (!ctx)
       {
         if constexpr (log::enabled)
@@ -52,10 +143,10 @@ struct Tls
           ERR_print_errors_fp(stderr);
           log::error("cannot create SSL");
         }
-        return {};
+        return nullptr;
       }
 
-      BIO *bio = detail::socket_BIO<Net>(fd);
+      BIO *bio = detail::endpoint_BIO<Net>(ctx, fd);
       SSL_set_bio(ctx, bio, bio);
       SSL_set_connect_state(ctx);
 
@@ -69,7 +160,7 @@ struct Tls
         }
 
         SSL_free(ctx);
-        return {};
+        return nullptr;
       }
 
       SSL_set_verify(ctx, SSL_VERIFY_PEER, nullptr);
@@ -82,10 +173,10 @@ struct Tls
           log::error("SSL_set1_host failed: {}", ERR_error_string(e, nullptr));
         }
         SSL_free(ctx);
-        return {};
+        return nullptr;
       }
 
-      return Endpoint{ctx};
+      return ctx;
     }
   };
 };
@@ -93,5 +184,6 @@ struct Tls
 } // namespace tls
 
 using Tls = tls::Tls;
+using TlsConfig = tls::TlsConfig;
 
 } // namespace manet::transport
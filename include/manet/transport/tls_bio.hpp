@@ -1,13 +1,17 @@
 #pragma once
 
+#include <array>
 #include <mutex>
 #include <openssl/bio.h>
 #include <openssl/err.h>
 #include <openssl/ssl.h>
 
 #include "manet/logging.hpp"
+#include "manet/net/concepts.hpp"
 #include "manet/reactor/io.hpp"
 #include "status.hpp"
+#include "tls_context.hpp"
+#include "tls_session.hpp"
 
 #if defined(LIBRESSL_VERSION_NUMBER)
 #error "LibreSSL not supported"
@@ -18,11 +22,10 @@
 namespace manet::transport::tls::detail
 {
 
-inline SSL_CTX *g_tls_ctx = nullptr;
-
 struct SocketBioData
 {
   int fd;
+  bool drained = false; // the last read returned less than asked for
 };
 
 int bio_create(BIO *bio);
@@ -37,8 +40,11 @@ template <typename Net> static int bio_read(BIO *bio, char *out, int outl)
   while (true)
   {
     ssize_t n = Net::read(data->fd, out, outl);
+    stats().reads++;
+
     if (n >= 0)
     {
+      data->drained = n < outl;
       return n;
     }
 
@@ -49,6 +55,7 @@ template <typename Net> static int bio_read(BIO *bio, char *out, int outl)
 
     if (errno == EAGAIN || errno == EWOULDBLOCK)
     {
+      data->drained = true;
       BIO_set_retry_read(bio);
     }
 
@@ -56,6 +63,18 @@ template <typename Net> static int bio_read(BIO *bio, char *out, int outl)
   }
 }
 
+/** whether the last read of `bio` (a socket_BIO) drained the socket */
+inline bool bio_drained(BIO *bio) noexcept
+{
+  // (OpenSSL's own socket BIO, used with kTLS, does not tell)
+  if (!bio || BIO_method_type(bio) != BIO_TYPE_SOURCE_SINK)
+  {
+    return false;
+  }
+
+  return static_cast<SocketBioData *>(BIO_get_data(bio))->drained;
+}
+
 template <typename Net> static int bio_write(BIO *bio, const char *in, int inl)
 {
   auto *data = static_cast<SocketBioData *>(BIO_get_data(bio));
@@ -113,25 +132,55 @@ template <typename Net> BIO *socket_BIO(int fd)
   return bio;
 }
 
-template <typename Net> inline void g_tls_free()
+#if defined(MANET_USE_KTLS) && !defined(OPENSSL_NO_KTLS)
+inline constexpr bool ktls_enabled = true;
+#else
+inline constexpr bool ktls_enabled = false;
+#endif
+
+/** BIO for a new SSL on `fd`.
+ *
+ * kTLS only works with OpenSSL's own socket BIO (the keys are installed via
+ * BIO_set_ktls once the handshake is done), if the kernel module or the
+ * negotiated cipher is not supported OpenSSL stays in userspace.
+ */
+template <typename Net> BIO *endpoint_BIO(SSL *ssl, int fd)
 {
-  if (g_tls_ctx)
+  if constexpr (ktls_enabled && net::KernelSockets<Net>)
+  {
+    // the kernel hands out whole records, nothing to read ahead
+    SSL_set_read_ahead(ssl, 0);
+    SSL_set_options(ssl, SSL_OP_ENABLE_KTLS);
+    return BIO_new_socket(fd, BIO_NOCLOSE);
+  }
+  else
   {
-    SSL_CTX_free(g_tls_ctx);
-    g_tls_ctx = nullptr;
+    (void)ssl;
+    return socket_BIO<Net>(fd);
   }
+}
 
-  BIO_METHOD *meth = BIO_method<Net>();
-  if (meth)
+/** BIO methods in use (one per Net), freed at exit */
+inline std::array<BIO_METHOD *, 4> g_tls_methods{};
+
+inline void g_tls_free()
+{
+  free_sessions();
+  free_contexts(); // (pooled SSLs still use their BIO method)
+
+  for (BIO_METHOD *&meth : g_tls_methods)
   {
-    BIO_meth_free(meth);
+    if (meth)
+    {
+      BIO_meth_free(meth);
+      meth = nullptr;
+    }
   }
 
   OPENSSL_cleanup();
 }
 
-/** this should not be called twice with different Net (normal) */
-template <typename Net> inline void g_tls_init()
+inline void g_tls_library_init()
 {
   static std::once_flag once;
 
@@ -143,22 +192,32 @@ template <typename Net> inline void g_tls_init()
       OpenSSL_add_all_algorithms();
       SSL_load_error_strings();
 
-      g_tls_ctx = SSL_CTX_new(TLS_client_method());
-      if (!g_tls_ctx)
-      {
-        throw std::runtime_error("SSL_CTX_new error");
-      }
+      std::atexit(g_tls_free);
+    }
+  );
+}
 
-      // trust store:
-      if (SSL_CTX_set_default_verify_paths(g_tls_ctx) != 1)
+/** the library is initialised once, the BIO method once per Net */
+template <typename Net> inline void g_tls_init()
+{
+  static std::once_flag once;
+
+  std::call_once(
+    once,
+    []
+    {
+      g_tls_library_init();
+
+      for (BIO_METHOD *&meth : g_tls_methods)
       {
-        throw std::runtime_error("SSL_CTX_set_default_verify_paths error");
+        if (!meth)
+        {
+          meth = BIO_method<Net>();
+          return;
+        }
       }
 
-      // require at least TLS 1.2
-      SSL_CTX_set_min_proto_version(g_tls_ctx, TLS1_2_VERSION);
-
-      std::atexit(g_tls_free<Net>);
+      log::error("too many Net types for TLS ({})", Net::name);
     }
   );
 }
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <openssl/ssl.h>
+
+namespace manet::transport::tls
+{
+
+/** Per-connection TLS configuration (`Tls::config_t`).
+ *
+ * Only `host` is required, unset (null) fields keep the defaults. All fields
+ * but `host` and `port` select the SSL_CTX: connections with equal settings
+ * share one (built on first use), so each distinct configuration loads its
+ * trust store only once.
+ */
+struct TlsConfig
+{
+  const char *host = nullptr; // SNI and verified host name
+  uint16_t port = 0;          // sessions are resumed per host and port
+
+  // TLS 1.3 suites (default: AES-128-GCM first with AES-NI, ChaCha20 otw.)
+  const char *ciphersuites = nullptr;
+  const char *cipher_list = nullptr; // TLS 1.2 cipher list
+  const char *groups = nullptr;      // key exchange groups, e.g. "X25519:P-256"
+
+  const char *alpn = nullptr; // comma separated, e.g. "http/1.1"
+
+  // trust: a pinned CA bundle instead of the system store, and/or the
+  // base64 SHA-256 of the server's SubjectPublicKeyInfo (a pin alone skips
+  // chain verification, the key is authenticated by the pin)
+  const char *ca_file = nullptr;
+  const char *spki_pin = nullptr;
+
+  // client certificate (PEM chain and key)
+  const char *cert_file = nullptr;
+  const char *key_file = nullptr;
+
+  // bytes per SSL_write, rounded down to full records (0: all of TX)
+  std::size_t max_write = 0;
+
+  // send the protocol's first bytes as TLS 1.3 early data (0-RTT) when
+  // resuming a session that allows it (replayable: idempotent requests only)
+  bool early_data = false;
+
+  // a socket read that returns less than asked for drained it: once SSL has
+  // no buffered record left, report want_read instead of reading until EAGAIN
+  bool short_read_drained = false;
+};
+
+namespace detail
+{
+
+/** shared SSL_CTX for the settings of `config` (nullptr on error) */
+SSL_CTX *context(const TlsConfig &config) noexcept;
+
+/** TLS 1.3 suites preferred by this CPU */
+const char *default_ciphersuites() noexcept;
+
+/** Idle SSL objects per context, BIO method (Net) and host.
+ *
+ * Released SSLs are reset with SSL_clear, which keeps their BIO, SNI and
+ * host name verification: `acquire_ssl` hands one out for the same host
+ * (only its fd needs rebinding) or returns nullptr if there is none.
+ */
+SSL *acquire_ssl(
+  SSL_CTX *ctx, const BIO_METHOD *method, const char *host
+) noexcept;
+
+/** keep `ssl` for reuse (false if it cannot be kept: free it) */
+bool release_ssl(
+  SSL *ssl, const BIO_METHOD *method, const char *host
+) noexcept;
+
+void free_contexts() noexcept;
+
+} // namespace detail
+
+} // namespace manet::transport::tls
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <openssl/ssl.h>
+
+#include "manet/utils/histogram.hpp"
+
+namespace manet::transport::tls
+{
+
+/** handshake counters of all TLS endpoints (single Net, no locking) */
+struct Stats
+{
+  uint64_t resumed = 0; // abbreviated handshakes (session ticket / PSK)
+  uint64_t full = 0;    // full handshakes
+
+  uint64_t ktls_tx = 0; // handshakes that switched TX to kernel TLS
+  uint64_t ktls_rx = 0; // handshakes that switched RX to kernel TLS
+
+  uint64_t early_accepted = 0; // 0-RTT handshakes whose early data was used
+  uint64_t early_rejected = 0; // ... and those that had to resend it
+
+  uint64_t ssl_new = 0;    // SSL objects created (SSL_new + BIO)
+  uint64_t ssl_reused = 0; // ... and taken from the pool instead
+
+  uint64_t reads = 0;   // Net::read calls of the BIO (including EAGAIN)
+  uint64_t records = 0; // SSL_read calls returning data (one record each)
+
+  utils::Histogram handshake_ns; // first handshake_step until established
+};
+
+Stats &stats() noexcept;
+
+namespace detail
+{
+
+/** Client session cache keyed by SSL_CTX (one per TlsConfig), SNI host and
+ * port.
+ *
+ * New sessions (TLS 1.3 tickets arrive after the handshake) are stored by
+ * `cache_session` (SSL_CTX_sess_set_new_cb), `resume_session` offers the
+ * cached session of a host to a new SSL of the same context unless it
+ * expired. A resumed handshake verifies no certificate: a session made under
+ * one config must not be offered under a stricter one.
+ */
+int cache_session(SSL *ssl, SSL_SESSION *session) noexcept;
+
+/** offer the cached session for `host`:`port` (returns true if one was set),
+ * the port is kept on `ssl` for `cache_session` and `forget_session` */
+bool resume_session(SSL *ssl, const char *host, uint16_t port) noexcept;
+
+/** drop the cached session of `ssl`'s host and port (for example after a
+ * failed resume) */
+void forget_session(SSL *ssl, const char *host) noexcept;
+
+void free_sessions() noexcept;
+
+} // namespace detail
+
+} // namespace manet::transport::tls
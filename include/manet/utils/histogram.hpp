@@ -0,0 +1,84 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+namespace manet::utils
+{
+
+/** Fixed-size log2 histogram (bucket `i` counts values in [2^(i-1), 2^i)).
+ *
+ * Recording is branch-free apart from min/max and never allocates, quantiles
+ * are reported as the upper bound of their bucket.
+ */
+class Histogram
+{
+public:
+  static constexpr std::size_t BUCKETS = 65;
+
+  void record(uint64_t value) noexcept
+  {
+    _buckets[std::bit_width(value)]++;
+    _count++;
+    _sum += value;
+
+    if (value < _min)
+    {
+      _min = value;
+    }
+    if (_max < value)
+    {
+      _max = value;
+    }
+  }
+
+  uint64_t count() const noexcept { return _count; }
+  uint64_t sum() const noexcept { return _sum; }
+  uint64_t min() const noexcept { return _count ? _min : 0; }
+  uint64_t max() const noexcept { return _max; }
+  uint64_t mean() const noexcept { return _count ? _sum / _count : 0; }
+
+  /** upper bound of the bucket holding the `q`-quantile (0 if empty) */
+  uint64_t quantile(double q) const noexcept
+  {
+    if (_count == 0)
+    {
+      return 0;
+    }
+
+    auto rank = static_cast<uint64_t>(q * static_cast<double>(_count - 1)) + 1;
+
+    uint64_t seen = 0;
+    for (std::size_t i = 0; i < BUCKETS; i++)
+    {
+      seen += _buckets[i];
+      if (rank <= seen)
+      {
+        return i == 0 ? 0 : std::min(_max, (uint64_t(2) << (i - 1)) - 1);
+      }
+    }
+
+    return _max;
+  }
+
+  const std::array<uint64_t, BUCKETS> &buckets() const noexcept
+  {
+    return _buckets;
+  }
+
+  void clear() noexcept { *this = Histogram{}; }
+
+private:
+  std::array<uint64_t, BUCKETS> _buckets{};
+
+  uint64_t _count = 0;
+  uint64_t _sum = 0;
+  uint64_t _min = std::numeric_limits<uint64_t>::max();
+  uint64_t _max = 0;
+};
+
+} // namespace manet::utils
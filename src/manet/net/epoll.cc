@@ -8,18 +8,69 @@
 #include "manet/net/concepts.hpp"
 #include "manet/net/epoll.hpp"
 
+#ifndef EPIOCSPARAMS
+// <linux/eventpoll.h> before 6.9
+struct epoll_params
+{
+  uint32_t busy_poll_usecs;
+  uint16_t busy_poll_budget;
+  uint8_t prefer_busy_poll;
+  uint8_t __pad;
+};
+
+#define EPIOCSPARAMS _IOW(0x8A, 0x01, struct epoll_params)
+#endif
+
+#ifndef SO_PREFER_BUSY_POLL
+#define SO_PREFER_BUSY_POLL 69
+#endif
+
 namespace manet::net
 {
 
 int Epoll::_event_fd = -1;
 int Epoll::_signal_fd = -1;
+int Epoll::_wake_fd = -1;
 bool Epoll::_alive = false;
 
+EpollConfig Epoll::_config = {};
+EpollBusyPoll Epoll::_busy_poll = {};
+
 /* sockets */
 
 Epoll::fd_t Epoll::socket(int domain, int type, int proto) noexcept
 {
-  return ::socket(domain, type | SOCK_NONBLOCK, proto);
+  fd_t fd = ::socket(domain, type | SOCK_NONBLOCK, proto);
+
+  if (fd != -1 && _config.socket_busy_poll_usecs > 0)
+  {
+    int usecs = static_cast<int>(_config.socket_busy_poll_usecs);
+    int prefer = 1;
+
+    bool ok =
+      ::setsockopt(fd, SOL_SOCKET, SO_BUSY_POLL, &usecs, sizeof(usecs)) == 0 &&
+      (!_config.prefer_busy_poll ||
+       ::setsockopt(
+         fd, SOL_SOCKET, SO_PREFER_BUSY_POLL, &prefer, sizeof(prefer)
+       ) == 0);
+
+    // log when the kernel starts accepting (or rejecting) it
+    if (ok != _busy_poll.sockets)
+    {
+      if (ok)
+      {
+        log::info("socket busy polling enabled ({}us)", usecs);
+      }
+      else
+      {
+        log::warn("socket busy polling rejected: {}", std::strerror(errno));
+      }
+    }
+
+    _busy_poll.sockets = ok;
+  }
+
+  return fd;
 }
 
 int Epoll::ioctl(fd_t fd, long req, void *argp) noexcept
@@ -27,6 +78,11 @@ int Epoll::ioctl(fd_t fd, long req, void *argp) noexcept
   return ::ioctl(fd, req, argp);
 }
 
+int Epoll::bind(fd_t fd, const void *sa, socklen_t l) noexcept
+{
+  return ::bind(fd, (const sockaddr *)sa, l);
+}
+
 int Epoll::connect(fd_t fd, const void *sa, socklen_t l) noexcept
 {
   return ::connect(fd, (const sockaddr *)sa, l);
@@ -41,6 +97,13 @@ int Epoll::getsockopt(
   return ::getsockopt(fd, level, opt_name, opt_val, opt_len);
 }
 
+int Epoll::setsockopt(
+  fd_t fd, int level, int opt_name, const void *opt_val, socklen_t opt_len
+) noexcept
+{
+  return ::setsockopt(fd, level, opt_name, opt_val, opt_len);
+}
+
 ssize_t Epoll::read(fd_t fd, void *buf, std::size_t len) noexcept
 {
   return ::read(fd, buf, len);
@@ -53,7 +116,7 @@ ssize_t Epoll::write(fd_t fd, const void *buf, std::size_t len) noexcept
 
 /* lifecycle */
 
-void Epoll::init(std::monostate)
+void Epoll::init(config_t config)
 {
   _event_fd = epoll_create1(EPOLL_CLOEXEC);
   if (_event_fd < 0)
@@ -61,6 +124,28 @@ void Epoll::init(std::monostate)
     throw std::runtime_error("failed to create epoll fd");
   }
 
+  _config = config;
+  _busy_poll = {};
+
+  if (config.busy_poll_usecs > 0)
+  {
+    epoll_params params{};
+    params.busy_poll_usecs = config.busy_poll_usecs;
+    params.busy_poll_budget = config.busy_poll_budget;
+    params.prefer_busy_poll = config.prefer_busy_poll;
+
+    _busy_poll.epoll = ::ioctl(_event_fd, EPIOCSPARAMS, &params) == 0;
+
+    if (_busy_poll.epoll)
+    {
+      log::info("epoll busy polling enabled ({}us)", config.busy_poll_usecs);
+    }
+    else
+    {
+      log::warn("epoll busy polling rejected: {}", std::strerror(errno));
+    }
+  }
+
   _signal_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
   if (_signal_fd < 0)
   {
@@ -76,6 +161,19 @@ void Epoll::init(std::monostate)
     throw std::runtime_error("failed to subscribe to killfd");
   }
 
+  _wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (_wake_fd < 0)
+  {
+    throw std::runtime_error("failed to create wake eventfd");
+  }
+
+  ev.data.fd = _wake_fd;
+
+  if (epoll_ctl(_event_fd, EPOLL_CTL_ADD, _wake_fd, &ev) < 0)
+  {
+    throw std::runtime_error("failed to subscribe to wakefd");
+  }
+
   _alive = true;
 }
 
@@ -106,6 +204,12 @@ void Epoll::stop() noexcept
     _signal_fd = -1;
   }
 
+  if (_wake_fd != -1)
+  {
+    ::close(_wake_fd);
+    _wake_fd = -1;
+  }
+
   if (_event_fd != -1)
   {
     ::close(_event_fd);
@@ -113,7 +217,16 @@ void Epoll::stop() noexcept
   }
 }
 
-int Epoll::poll(event_t events[], std::size_t len) noexcept
+void Epoll::wake() noexcept
+{
+  if (_wake_fd != -1)
+  {
+    uint64_t one = 1;
+    write(_wake_fd, &one, sizeof(one));
+  }
+}
+
+int Epoll::poll(event_t events[], std::size_t len, int timeout_ms) noexcept
 {
   constexpr auto max_int_size_t =
     static_cast<std::size_t>(std::numeric_limits<int>::max());
@@ -121,9 +234,7 @@ int Epoll::poll(event_t events[], std::size_t len) noexcept
   // clamp
   len = len < max_int_size_t ? len : max_int_size_t;
 
-  return epoll_wait(
-    _event_fd, events, static_cast<int>(len), poll_frequency_ms
-  );
+  return epoll_wait(_event_fd, events, static_cast<int>(len), timeout_ms);
 }
 
 /* events */
@@ -143,6 +254,21 @@ bool Epoll::ev_signal(const event_t &ev) noexcept
   return false;
 }
 
+bool Epoll::ev_wake(const event_t &ev) noexcept
+{
+  if (ev.data.fd == _wake_fd && (ev.events & EPOLLIN))
+  {
+    // drain fd (one event for any number of wakes)
+    uint64_t discard;
+    std::size_t n = ::read(_wake_fd, &discard, sizeof(discard));
+    (void)n;
+
+    return true;
+  }
+
+  return false;
+}
+
 bool Epoll::ev_close(const event_t &ev) noexcept
 {
   return (ev.events & (EPOLLHUP | EPOLLRDHUP)) != 0;
@@ -5,6 +5,7 @@
 #include "manet/net/fstack.hpp"
 
 #define KILL_IDENT 1
+#define WAKE_IDENT 2
 
 namespace manet::net
 {
@@ -23,6 +24,11 @@ int FStack::ioctl(fd_t fd, long req, void *arg) noexcept
   return ff_ioctl(fd, req, arg);
 }
 
+int FStack::bind(fd_t fd, const void *sa, socklen_t l) noexcept
+{
+  return ff_bind(fd, (const linux_sockaddr *)sa, l);
+}
+
 int FStack::connect(fd_t fd, const void *sa, socklen_t l) noexcept
 {
   return ff_connect(fd, (const linux_sockaddr *)sa, l);
@@ -37,6 +43,13 @@ int FStack::getsockopt(
   return ff_getsockopt(fd, level, opt_name, opt_val, opt_len);
 }
 
+int FStack::setsockopt(
+  fd_t fd, int level, int opt_name, const void *opt_val, socklen_t opt_len
+) noexcept
+{
+  return ff_setsockopt(fd, level, opt_name, opt_val, opt_len);
+}
+
 ssize_t FStack::read(fd_t fd, void *buf, std::size_t len) noexcept
 {
   return ff_read(fd, buf, len);
@@ -70,15 +83,22 @@ void FStack::init(config_t config_file)
   {
     throw std::runtime_error("failed to create kqueue");
   }
+
+  struct kevent wake;
+  EV_SET(&wake, WAKE_IDENT, EVFILT_USER, EV_ADD | EV_CLEAR, 0, 0, nullptr);
+  if (ff_kevent(_kq, &wake, 1, nullptr, 0, nullptr) < 0)
+  {
+    throw std::runtime_error("failed to register the wake event");
+  }
 }
 
 void FStack::run(loop_func_t loop, void *arg) { ff_run(loop, arg); }
 
-int FStack::poll(event_t events[], std::size_t len) noexcept
+int FStack::poll(event_t events[], std::size_t len, int timeout_ms) noexcept
 {
   struct timespec ts;
-  ts.tv_sec = 0;
-  ts.tv_nsec = poll_frequency_ms * 1000 * 1000; // NOLINT
+  ts.tv_sec = timeout_ms / 1000;
+  ts.tv_nsec = (timeout_ms % 1000) * 1000 * 1000; // NOLINT
 
   constexpr auto max_int_size_t =
     static_cast<std::size_t>(std::numeric_limits<int>::max());
@@ -96,6 +116,13 @@ void FStack::signal() noexcept
   ff_kevent(_kq, &signal, 1, nullptr, 0, nullptr);
 }
 
+void FStack::wake() noexcept
+{
+  struct kevent wake;
+  EV_SET(&wake, WAKE_IDENT, EVFILT_USER, 0, NOTE_TRIGGER, 0, nullptr);
+  ff_kevent(_kq, &wake, 1, nullptr, 0, nullptr);
+}
+
 void FStack::stop() noexcept
 {
   // ff_dpdk_stop();
@@ -113,6 +140,11 @@ bool FStack::ev_signal(const event_t &ev) noexcept
   return ev.ident == KILL_IDENT && ev.filter == EVFILT_USER;
 }
 
+bool FStack::ev_wake(const event_t &ev) noexcept
+{
+  return ev.ident == WAKE_IDENT && ev.filter == EVFILT_USER;
+}
+
 bool FStack::ev_close(const event_t &ev) noexcept
 {
   return (ev.flags & EV_EOF) != 0;
@@ -0,0 +1,1170 @@
+#include <algorithm>
+#include <atomic>
+#include <csignal>
+#include <cstring>
+#include <ctime>
+#include <stdexcept>
+#include <vector>
+
+#include <linux/io_uring.h>
+#include <sys/eventfd.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "manet/logging.hpp"
+#include "manet/net/concepts.hpp"
+#include "manet/net/io_uring.hpp"
+
+namespace manet::net
+{
+
+static_assert(Net<IoUring>);
+static_assert(LendsBuffers<IoUring>);
+
+namespace
+{
+
+/* user_data: | generation (32) | fd (24) | op (8) | */
+
+enum Op : uint8_t
+{
+  op_recv = 1,
+  op_pollout,
+  op_signal,
+  op_wake,
+  op_cancel,
+  op_provide,
+  op_probe
+};
+
+constexpr uint16_t BUFFER_GROUP = 0;
+
+/** a received buffer (not read completely yet) */
+struct Chunk
+{
+  uint16_t bid;
+  uint32_t len;
+  uint32_t off;
+};
+
+struct Socket
+{
+  void *ptr = nullptr;
+  uint32_t gen = 0;
+
+  bool open = false;
+  bool recv_armed = false;
+  bool pollout_armed = false;
+  bool starved = false; // recv ended for lack of buffers
+  bool eof = false;
+  int err = 0;
+
+  uint32_t ready = 0;  // events not reported yet
+  bool listed = false; // in `ready`
+
+  std::vector<Chunk> chunks; // FIFO from `head`
+  std::size_t head = 0;
+
+  int lent = -1; // buffer handed out by `lend` (back with the next read)
+};
+
+template <typename T> T load_acquire(T *p) noexcept
+{
+  return std::atomic_ref<T>(*p).load(std::memory_order_acquire);
+}
+
+template <typename T> void store_release(T *p, T v) noexcept
+{
+  std::atomic_ref<T>(*p).store(v, std::memory_order_release);
+}
+
+struct Ring
+{
+  int fd = -1;
+  bool sqpoll = false;
+
+  // submission queue
+  unsigned *sq_head = nullptr;
+  unsigned *sq_tail = nullptr;
+  unsigned *sq_flags = nullptr;
+  unsigned *sq_array = nullptr;
+  unsigned sq_mask = 0;
+  unsigned sq_entries = 0;
+  io_uring_sqe *sqes = nullptr;
+
+  unsigned tail = 0;    // local SQ tail
+  unsigned pending = 0; // queued, not submitted
+
+  // completion queue
+  unsigned *cq_head = nullptr;
+  unsigned *cq_tail = nullptr;
+  unsigned cq_mask = 0;
+  io_uring_cqe *cqes = nullptr;
+
+  // mappings
+  void *sq_ring = MAP_FAILED;
+  std::size_t sq_ring_len = 0;
+  void *cq_ring = MAP_FAILED;
+  std::size_t cq_ring_len = 0;
+  std::size_t sqes_len = 0;
+
+  // provided buffers: a registered ring (or SQEs with `legacy` buffers)
+  io_uring_buf_ring *br = nullptr;
+  std::size_t br_len = 0;
+  uint16_t br_tail = 0;
+  unsigned br_mask = 0;
+
+  std::byte *buffers = nullptr;
+  std::size_t buffers_len = 0;
+  std::size_t buffer_size = 0;
+  bool legacy = false;
+
+  int signal_fd = -1;
+  bool signalled = false;
+
+  int wake_fd = -1;
+  bool woken = false;
+
+  std::vector<Socket> sockets;
+  std::vector<int> ready;   // fds with events to report
+  std::vector<int> starved; // fds to re-arm once buffers are back
+};
+
+Ring ring;
+bool alive = false;
+
+Socket *lookup(int fd) noexcept
+{
+  if (fd < 0 || ring.sockets.size() <= static_cast<std::size_t>(fd))
+  {
+    return nullptr;
+  }
+
+  Socket &s = ring.sockets[fd];
+  return s.open ? &s : nullptr;
+}
+
+uint64_t user_data(int fd, const Socket &s, Op op) noexcept
+{
+  return (static_cast<uint64_t>(s.gen) << 32) |
+         (static_cast<uint64_t>(fd & 0xffffff) << 8) | op;
+}
+
+int enter(unsigned wait_nr, int timeout_ms) noexcept
+{
+  unsigned flags = 0;
+  unsigned to_submit = 0;
+
+  if (ring.sqpoll && 0 < ring.pending)
+  {
+    // (the kernel thread may go to sleep concurrently)
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (std::atomic_ref<unsigned>(*ring.sq_flags).load(
+          std::memory_order_relaxed
+        ) &
+        IORING_SQ_NEED_WAKEUP)
+    {
+      flags |= IORING_ENTER_SQ_WAKEUP;
+    }
+  }
+  else
+  {
+    to_submit = ring.pending;
+  }
+
+  ring.pending = 0;
+
+  io_uring_getevents_arg arg{};
+  __kernel_timespec ts{};
+
+  if (0 < wait_nr)
+  {
+    flags |= IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG;
+
+    ts.tv_sec = timeout_ms / 1000;
+    ts.tv_nsec = (timeout_ms % 1000) * 1000000L;
+
+    arg.sigmask_sz = _NSIG / 8;
+    arg.ts = reinterpret_cast<uint64_t>(&ts);
+  }
+  else if (flags == 0 && to_submit == 0)
+  {
+    return 0; // nothing to do
+  }
+
+  int r = static_cast<int>(::syscall(
+    __NR_io_uring_enter, ring.fd, to_submit, wait_nr, flags,
+    0 < wait_nr ? &arg : nullptr, 0 < wait_nr ? sizeof(arg) : 0
+  ));
+
+  if (r < 0 && (errno == ETIME || errno == EINTR || errno == EBUSY))
+  {
+    return 0;
+  }
+
+  return r;
+}
+
+/** next free SQE (zeroed), submits the queue if it is full */
+io_uring_sqe *next_sqe() noexcept
+{
+  if (ring.fd < 0)
+  {
+    return nullptr;
+  }
+
+  if (ring.tail - load_acquire(ring.sq_head) == ring.sq_entries)
+  {
+    (void)enter(0, 0);
+
+    if (ring.tail - load_acquire(ring.sq_head) == ring.sq_entries)
+    {
+      log::error("io_uring submission queue full");
+      return nullptr;
+    }
+  }
+
+  unsigned index = ring.tail & ring.sq_mask;
+
+  io_uring_sqe *sqe = &ring.sqes[index];
+  std::memset(sqe, 0, sizeof(*sqe));
+
+  ring.sq_array[index] = index;
+  return sqe;
+}
+
+/** publish the SQE filled since `next_sqe` */
+void push_sqe() noexcept
+{
+  store_release(ring.sq_tail, ++ring.tail);
+  ring.pending++;
+}
+
+void arm_recv(int fd, Socket &s) noexcept
+{
+  io_uring_sqe *sqe = next_sqe();
+  if (!sqe)
+  {
+    return;
+  }
+
+  sqe->opcode = IORING_OP_RECV;
+  sqe->fd = fd;
+  sqe->ioprio = IORING_RECV_MULTISHOT;
+  sqe->flags = IOSQE_BUFFER_SELECT;
+  sqe->buf_group = BUFFER_GROUP;
+  sqe->user_data = user_data(fd, s, op_recv);
+  push_sqe();
+
+  s.recv_armed = true;
+}
+
+void arm_pollout(int fd, Socket &s) noexcept
+{
+  io_uring_sqe *sqe = next_sqe();
+  if (!sqe)
+  {
+    return;
+  }
+
+  sqe->opcode = IORING_OP_POLL_ADD;
+  sqe->fd = fd;
+  sqe->poll32_events = POLLOUT;
+  sqe->user_data = user_data(fd, s, op_pollout);
+  push_sqe();
+
+  s.pollout_armed = true;
+}
+
+/** multishot poll of the kill (op_signal) or wake (op_wake) eventfd */
+void arm_eventfd(Op op) noexcept
+{
+  io_uring_sqe *sqe = next_sqe();
+  if (!sqe)
+  {
+    return;
+  }
+
+  sqe->opcode = IORING_OP_POLL_ADD;
+  sqe->fd = op == op_signal ? ring.signal_fd : ring.wake_fd;
+  sqe->len = IORING_POLL_ADD_MULTI;
+  sqe->poll32_events = POLLIN;
+  sqe->user_data = op;
+  push_sqe();
+}
+
+void cancel(uint64_t target) noexcept
+{
+  io_uring_sqe *sqe = next_sqe();
+  if (!sqe)
+  {
+    return;
+  }
+
+  sqe->opcode = IORING_OP_ASYNC_CANCEL;
+  sqe->fd = -1;
+  sqe->addr = target;
+  sqe->user_data = op_cancel;
+  push_sqe();
+}
+
+std::byte *buffer(uint16_t bid) noexcept
+{
+  return ring.buffers + static_cast<std::size_t>(bid) * ring.buffer_size;
+}
+
+/** provide `count` buffers from `bid` on (legacy: one SQE each time) */
+void provide(uint16_t bid, unsigned count) noexcept
+{
+  io_uring_sqe *sqe = next_sqe();
+  if (!sqe)
+  {
+    return;
+  }
+
+  sqe->opcode = IORING_OP_PROVIDE_BUFFERS;
+  sqe->fd = static_cast<int>(count);
+  sqe->addr = reinterpret_cast<uint64_t>(buffer(bid));
+  sqe->len = static_cast<uint32_t>(ring.buffer_size);
+  sqe->off = bid;
+  sqe->buf_group = BUFFER_GROUP;
+  sqe->user_data = op_provide;
+  push_sqe();
+}
+
+/** hand a buffer back to the kernel */
+void recycle(uint16_t bid) noexcept
+{
+  if (ring.br)
+  {
+    io_uring_buf &buf = ring.br->bufs[ring.br_tail & ring.br_mask];
+    buf.addr = reinterpret_cast<uint64_t>(buffer(bid));
+    buf.len = static_cast<uint32_t>(ring.buffer_size);
+    buf.bid = bid;
+
+    store_release(&ring.br->tail, ++ring.br_tail);
+  }
+  else if (ring.legacy)
+  {
+    provide(bid, 1);
+  }
+  else
+  {
+    return;
+  }
+
+  // sockets that ran out of buffers can receive again
+  for (int fd : ring.starved)
+  {
+    if (Socket *s = lookup(fd); s && s->starved)
+    {
+      s->starved = false;
+      arm_recv(fd, *s);
+    }
+  }
+
+  ring.starved.clear();
+}
+
+/** the buffer `lend` handed out is no longer used */
+void give_back(Socket &s) noexcept
+{
+  if (0 <= s.lent)
+  {
+    recycle(static_cast<uint16_t>(s.lent));
+    s.lent = -1;
+  }
+}
+
+/** `read` without bytes: the error, EOF or EAGAIN */
+ssize_t drained(const Socket &s) noexcept
+{
+  if (s.err != 0)
+  {
+    errno = s.err;
+    return -1;
+  }
+
+  if (s.eof)
+  {
+    return 0;
+  }
+
+  errno = EAGAIN;
+  return -1;
+}
+
+void mark(int fd, Socket &s, uint32_t events) noexcept
+{
+  s.ready |= events;
+
+  if (!s.listed)
+  {
+    s.listed = true;
+    ring.ready.push_back(fd);
+  }
+}
+
+bool has_input(const Socket &s) noexcept
+{
+  return s.head < s.chunks.size() || s.eof || s.err != 0;
+}
+
+void complete(const io_uring_cqe &cqe) noexcept
+{
+  auto op = static_cast<Op>(cqe.user_data & 0xff);
+  int fd = static_cast<int>((cqe.user_data >> 8) & 0xffffff);
+  auto gen = static_cast<uint32_t>(cqe.user_data >> 32);
+
+  bool more = cqe.flags & IORING_CQE_F_MORE;
+
+  if (op == op_signal || op == op_wake)
+  {
+    (op == op_signal ? ring.signalled : ring.woken) = true;
+    if (!more)
+    {
+      arm_eventfd(op);
+    }
+    return;
+  }
+
+  if (op == op_cancel || op == op_probe)
+  {
+    return;
+  }
+
+  if (op == op_provide)
+  {
+    if (cqe.res < 0)
+    {
+      log::error("io_uring provide buffers: {}", std::strerror(-cqe.res));
+    }
+    return;
+  }
+
+  Socket *s = lookup(fd);
+  if (!s || s->gen != gen)
+  {
+    // completion of a closed socket
+    if (cqe.flags & IORING_CQE_F_BUFFER)
+    {
+      recycle(static_cast<uint16_t>(cqe.flags >> IORING_CQE_BUFFER_SHIFT));
+    }
+    return;
+  }
+
+  if (op == op_pollout)
+  {
+    s->pollout_armed = false;
+    if (0 < cqe.res)
+    {
+      mark(fd, *s, static_cast<uint32_t>(cqe.res));
+    }
+    return;
+  }
+
+  // op_recv
+  if (!more)
+  {
+    s->recv_armed = false;
+  }
+
+  if (0 < cqe.res)
+  {
+    s->chunks.push_back(
+      Chunk{
+        .bid = static_cast<uint16_t>(cqe.flags >> IORING_CQE_BUFFER_SHIFT),
+        .len = static_cast<uint32_t>(cqe.res),
+        .off = 0
+      }
+    );
+    mark(fd, *s, POLLIN);
+  }
+  else if (cqe.res == 0)
+  {
+    s->eof = true;
+    mark(fd, *s, POLLIN);
+  }
+  else if (cqe.res == -ENOBUFS)
+  {
+    // all buffers are queued (unread): re-armed once some are recycled
+    s->starved = true;
+    ring.starved.push_back(fd);
+  }
+  else if (cqe.res != -ECANCELED)
+  {
+    s->err = -cqe.res;
+    mark(fd, *s, POLLIN | POLLERR);
+  }
+}
+
+void reap() noexcept
+{
+  unsigned head = *ring.cq_head;
+  unsigned tail = load_acquire(ring.cq_tail);
+
+  for (; head != tail; head++)
+  {
+    complete(ring.cqes[head & ring.cq_mask]);
+  }
+
+  store_release(ring.cq_head, head);
+}
+
+bool cq_empty() noexcept
+{
+  return *ring.cq_head == load_acquire(ring.cq_tail);
+}
+
+/** forget the socket's state, buffers go back to the ring */
+void release(int fd) noexcept
+{
+  Socket *s = lookup(fd);
+  if (!s)
+  {
+    return;
+  }
+
+  for (std::size_t i = s->head; i < s->chunks.size(); i++)
+  {
+    recycle(s->chunks[i].bid);
+  }
+
+  s->chunks.clear();
+  s->head = 0;
+
+  give_back(*s);
+
+  // in-flight requests keep the socket alive: cancel them right away
+  bool armed = false;
+  if (s->recv_armed)
+  {
+    cancel(user_data(fd, *s, op_recv));
+    armed = true;
+  }
+  if (s->pollout_armed)
+  {
+    cancel(user_data(fd, *s, op_pollout));
+    armed = true;
+  }
+  if (armed)
+  {
+    (void)enter(0, 0);
+  }
+
+  s->open = false;
+  s->ready = 0; // (stays listed until reported)
+}
+
+void *map(std::size_t len, off_t offset)
+{
+  void *ptr = ::mmap(
+    nullptr, len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring.fd,
+    offset
+  );
+  if (ptr == MAP_FAILED)
+  {
+    throw std::runtime_error("failed to map io_uring");
+  }
+  return ptr;
+}
+
+void setup_ring(const IoUringConfig &config)
+{
+  io_uring_params params{};
+
+  // every recv completion holds a buffer: room for all of them
+  params.flags = IORING_SETUP_CQSIZE;
+  params.cq_entries = 2 * std::max(config.entries, config.buffers);
+
+  if (config.sqpoll)
+  {
+    params.flags |= IORING_SETUP_SQPOLL;
+    params.sq_thread_idle = config.sqpoll_idle_ms;
+  }
+
+  ring.fd = static_cast<int>(
+    ::syscall(__NR_io_uring_setup, config.entries, &params)
+  );
+  if (ring.fd < 0)
+  {
+    throw std::runtime_error("failed to create io_uring");
+  }
+
+  if (!(params.features & IORING_FEAT_EXT_ARG))
+  {
+    throw std::runtime_error("io_uring lacks IORING_FEAT_EXT_ARG");
+  }
+
+  ring.sqpoll = config.sqpoll;
+
+  ring.sq_ring_len = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  ring.cq_ring_len =
+    params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+
+  if (params.features & IORING_FEAT_SINGLE_MMAP)
+  {
+    ring.sq_ring_len = ring.cq_ring_len =
+      std::max(ring.sq_ring_len, ring.cq_ring_len);
+  }
+
+  ring.sq_ring = map(ring.sq_ring_len, IORING_OFF_SQ_RING);
+  ring.cq_ring = params.features & IORING_FEAT_SINGLE_MMAP
+                   ? ring.sq_ring
+                   : map(ring.cq_ring_len, IORING_OFF_CQ_RING);
+
+  ring.sqes_len = params.sq_entries * sizeof(io_uring_sqe);
+  ring.sqes =
+    static_cast<io_uring_sqe *>(map(ring.sqes_len, IORING_OFF_SQES));
+
+  auto *sq = static_cast<std::byte *>(ring.sq_ring);
+  ring.sq_head = reinterpret_cast<unsigned *>(sq + params.sq_off.head);
+  ring.sq_tail = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+  ring.sq_flags = reinterpret_cast<unsigned *>(sq + params.sq_off.flags);
+  ring.sq_array = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+  ring.sq_mask = *reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+  ring.sq_entries = params.sq_entries;
+  ring.tail = *ring.sq_tail;
+
+  auto *cq = static_cast<std::byte *>(ring.cq_ring);
+  ring.cq_head = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+  ring.cq_tail = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+  ring.cq_mask = *reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+  ring.cqes = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+}
+
+/** whether the kernel picks buffers from the ring: receive a byte */
+bool probe_buffer_ring() noexcept
+{
+  int sv[2];
+  if (::socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sv) != 0)
+  {
+    return false;
+  }
+
+  bool ok = false;
+  char byte = 0;
+
+  io_uring_sqe *sqe = ::write(sv[1], &byte, 1) == 1 ? next_sqe() : nullptr;
+  if (sqe)
+  {
+    sqe->opcode = IORING_OP_RECV;
+    sqe->fd = sv[0];
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = BUFFER_GROUP;
+    sqe->user_data = op_probe;
+    push_sqe();
+
+    if (0 <= enter(1, poll_frequency_ms) && !cq_empty())
+    {
+      const io_uring_cqe &cqe = ring.cqes[*ring.cq_head & ring.cq_mask];
+      ok = cqe.res == 1;
+
+      if (cqe.flags & IORING_CQE_F_BUFFER)
+      {
+        recycle(static_cast<uint16_t>(cqe.flags >> IORING_CQE_BUFFER_SHIFT));
+      }
+
+      reap(); // (the probe's completion is ignored)
+    }
+  }
+
+  ::close(sv[0]);
+  ::close(sv[1]);
+
+  return ok;
+}
+
+bool setup_buffer_ring(unsigned n)
+{
+  ring.br_len = n * sizeof(io_uring_buf);
+  void *br = ::mmap(
+    nullptr, ring.br_len, PROT_READ | PROT_WRITE,
+    MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0
+  );
+  if (br == MAP_FAILED)
+  {
+    throw std::runtime_error("failed to allocate io_uring buffer ring");
+  }
+
+  ring.br = static_cast<io_uring_buf_ring *>(br);
+  ring.br_mask = n - 1;
+  ring.br_tail = 0;
+
+  io_uring_buf_reg reg{};
+  reg.ring_addr = reinterpret_cast<uint64_t>(ring.br);
+  reg.ring_entries = n;
+  reg.bgid = BUFFER_GROUP;
+
+  if (::syscall(
+        __NR_io_uring_register, ring.fd, IORING_REGISTER_PBUF_RING, &reg, 1
+      ) == 0)
+  {
+    for (unsigned bid = 0; bid < n; bid++)
+    {
+      recycle(static_cast<uint16_t>(bid));
+    }
+
+    if (probe_buffer_ring())
+    {
+      return true;
+    }
+
+    (void)::syscall(
+      __NR_io_uring_register, ring.fd, IORING_UNREGISTER_PBUF_RING, &reg, 1
+    );
+  }
+
+  ::munmap(ring.br, ring.br_len);
+  ring.br = nullptr;
+
+  return false;
+}
+
+void setup_buffers(const IoUringConfig &config)
+{
+  unsigned n = config.buffers;
+  if (n == 0 || 32768 < n || (n & (n - 1)) != 0 || config.buffer_size == 0)
+  {
+    throw std::invalid_argument("io_uring buffers: power of two <= 32768");
+  }
+
+  ring.buffer_size = config.buffer_size;
+  ring.buffers_len = static_cast<std::size_t>(n) * config.buffer_size;
+
+  void *buffers = ::mmap(
+    nullptr, ring.buffers_len, PROT_READ | PROT_WRITE,
+    MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0
+  );
+  if (buffers == MAP_FAILED)
+  {
+    throw std::runtime_error("failed to allocate io_uring buffers");
+  }
+
+  ring.buffers = static_cast<std::byte *>(buffers);
+
+  if (!setup_buffer_ring(n))
+  {
+    // (kernels before 5.19 or ones that do not see the ring's updates)
+    log::warn("io_uring buffer ring unavailable, providing buffers by SQE");
+
+    ring.legacy = true;
+    provide(0, n);
+  }
+}
+
+void teardown() noexcept
+{
+  if (ring.signal_fd != -1)
+  {
+    ::close(ring.signal_fd);
+    ring.signal_fd = -1;
+  }
+
+  if (ring.wake_fd != -1)
+  {
+    ::close(ring.wake_fd);
+    ring.wake_fd = -1;
+  }
+
+  // closing the ring cancels all requests (and unregisters the buffers)
+  if (ring.fd != -1)
+  {
+    ::close(ring.fd);
+    ring.fd = -1;
+  }
+
+  if (ring.sqes)
+  {
+    ::munmap(ring.sqes, ring.sqes_len);
+  }
+  if (ring.cq_ring != MAP_FAILED && ring.cq_ring != ring.sq_ring)
+  {
+    ::munmap(ring.cq_ring, ring.cq_ring_len);
+  }
+  if (ring.sq_ring != MAP_FAILED)
+  {
+    ::munmap(ring.sq_ring, ring.sq_ring_len);
+  }
+  if (ring.br)
+  {
+    ::munmap(ring.br, ring.br_len);
+  }
+  if (ring.buffers)
+  {
+    ::munmap(ring.buffers, ring.buffers_len);
+  }
+
+  // (sockets closed later find no state)
+  ring = Ring{};
+}
+
+} // namespace
+
+/* sockets */
+
+IoUring::fd_t IoUring::socket(int domain, int type, int proto) noexcept
+{
+  int fd = ::socket(domain, type | SOCK_NONBLOCK, proto);
+  if (fd < 0 || 0xffffff < fd)
+  {
+    return fd;
+  }
+
+  try
+  {
+    if (ring.sockets.size() <= static_cast<std::size_t>(fd))
+    {
+      ring.sockets.resize(fd + 1);
+    }
+  }
+  catch (...)
+  {
+    ::close(fd);
+    errno = ENOMEM;
+    return -1;
+  }
+
+  // fresh state, a new generation tells its completions apart
+  Socket &s = ring.sockets[fd];
+  s.ptr = nullptr;
+  s.gen++;
+  s.open = true;
+  s.recv_armed = s.pollout_armed = s.starved = s.eof = false;
+  s.err = 0;
+  s.ready = 0;
+  s.chunks.clear();
+  s.head = 0;
+  s.lent = -1;
+
+  return fd;
+}
+
+int IoUring::ioctl(fd_t fd, long req, void *argp) noexcept
+{
+  return ::ioctl(fd, req, argp);
+}
+
+int IoUring::bind(fd_t fd, const void *sa, socklen_t l) noexcept
+{
+  return ::bind(fd, (const sockaddr *)sa, l);
+}
+
+int IoUring::connect(fd_t fd, const void *sa, socklen_t l) noexcept
+{
+  return ::connect(fd, (const sockaddr *)sa, l);
+}
+
+int IoUring::close(fd_t fd) noexcept
+{
+  release(fd);
+  return ::close(fd);
+}
+
+int IoUring::getsockopt(
+  fd_t fd, int level, int opt_name, void *opt_val, socklen_t *opt_len
+) noexcept
+{
+  return ::getsockopt(fd, level, opt_name, opt_val, opt_len);
+}
+
+int IoUring::setsockopt(
+  fd_t fd, int level, int opt_name, const void *opt_val, socklen_t opt_len
+) noexcept
+{
+  return ::setsockopt(fd, level, opt_name, opt_val, opt_len);
+}
+
+ssize_t IoUring::read(fd_t fd, void *buf, std::size_t len) noexcept
+{
+  Socket *s = lookup(fd);
+  if (!s)
+  {
+    errno = EBADF;
+    return -1;
+  }
+
+  give_back(*s);
+
+  auto *out = static_cast<std::byte *>(buf);
+  std::size_t n = 0;
+
+  while (n < len && s->head < s->chunks.size())
+  {
+    Chunk &chunk = s->chunks[s->head];
+
+    std::size_t k = std::min<std::size_t>(len - n, chunk.len - chunk.off);
+    std::memcpy(out + n, buffer(chunk.bid) + chunk.off, k);
+
+    chunk.off += k;
+    n += k;
+
+    if (chunk.off == chunk.len)
+    {
+      recycle(chunk.bid);
+      s->head++;
+    }
+  }
+
+  if (s->head == s->chunks.size())
+  {
+    s->chunks.clear();
+    s->head = 0;
+  }
+
+  if (0 < n)
+  {
+    return static_cast<ssize_t>(n);
+  }
+
+  return drained(*s);
+}
+
+ssize_t IoUring::lend(fd_t fd, std::span<const std::byte> &out) noexcept
+{
+  Socket *s = lookup(fd);
+  if (!s)
+  {
+    errno = EBADF;
+    return -1;
+  }
+
+  give_back(*s);
+
+  if (s->head == s->chunks.size())
+  {
+    return drained(*s);
+  }
+
+  Chunk chunk = s->chunks[s->head++];
+
+  if (s->head == s->chunks.size())
+  {
+    s->chunks.clear();
+    s->head = 0;
+  }
+
+  s->lent = chunk.bid;
+  out = {buffer(chunk.bid) + chunk.off, chunk.len - chunk.off};
+
+  return static_cast<ssize_t>(out.size());
+}
+
+ssize_t IoUring::write(fd_t fd, const void *buf, std::size_t len) noexcept
+{
+  return ::write(fd, buf, len);
+}
+
+/* lifecycle */
+
+void IoUring::init(config_t config)
+{
+  try
+  {
+    setup_ring(config);
+    setup_buffers(config);
+
+    ring.signal_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (ring.signal_fd < 0)
+    {
+      throw std::runtime_error("failed to create kill eventfd");
+    }
+
+    ring.wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (ring.wake_fd < 0)
+    {
+      throw std::runtime_error("failed to create wake eventfd");
+    }
+
+    arm_eventfd(op_signal);
+    arm_eventfd(op_wake);
+  }
+  catch (...)
+  {
+    teardown();
+    throw;
+  }
+
+  alive = true;
+}
+
+void IoUring::run(int (*loop)(void *arg), void *arg)
+{
+  while (alive)
+  {
+    loop(arg);
+  }
+}
+
+void IoUring::signal() noexcept
+{
+  int fd = ring.signal_fd;
+  if (fd != -1)
+  {
+    uint64_t one = 1;
+    (void)::write(fd, &one, sizeof(one));
+  }
+}
+
+void IoUring::wake() noexcept
+{
+  int fd = ring.wake_fd;
+  if (fd != -1)
+  {
+    uint64_t one = 1;
+    (void)::write(fd, &one, sizeof(one));
+  }
+}
+
+void IoUring::stop() noexcept
+{
+  alive = false;
+  teardown();
+}
+
+int IoUring::poll(event_t events[], std::size_t len, int timeout_ms) noexcept
+{
+  if (ring.fd < 0)
+  {
+    return -1;
+  }
+
+  // wait only if there is nothing to report
+  bool idle = ring.ready.empty() && !ring.signalled && !ring.woken;
+
+  int r = 0 < timeout_ms && idle && cq_empty() ? enter(1, timeout_ms)
+                                               : enter(0, 0);
+  if (r < 0)
+  {
+    log::error("io_uring_enter failed: {}", std::strerror(errno));
+    return -1;
+  }
+
+  reap();
+
+  std::size_t n = 0;
+
+  if (ring.signalled && n < len)
+  {
+    ring.signalled = false;
+    events[n++] = event_t{.ptr = nullptr, .events = SIGNAL};
+  }
+
+  if (ring.woken && n < len)
+  {
+    ring.woken = false;
+    events[n++] = event_t{.ptr = nullptr, .events = WAKE};
+  }
+
+  std::size_t i = 0;
+  for (; i < ring.ready.size() && n < len; i++)
+  {
+    Socket &s = ring.sockets[ring.ready[i]];
+    s.listed = false;
+
+    if (s.ready != 0)
+    {
+      events[n++] = event_t{.ptr = s.ptr, .events = s.ready};
+      s.ready = 0;
+    }
+  }
+
+  ring.ready.erase(ring.ready.begin(), ring.ready.begin() + i);
+
+  return static_cast<int>(n);
+}
+
+/* events */
+
+bool IoUring::ev_signal(const event_t &ev) noexcept
+{
+  if (ev.events & SIGNAL)
+  {
+    // drain fd
+    uint64_t discard;
+    std::size_t n = ::read(ring.signal_fd, &discard, sizeof(discard));
+    (void)n;
+
+    return true;
+  }
+
+  return false;
+}
+
+bool IoUring::ev_wake(const event_t &ev) noexcept
+{
+  if (ev.events & WAKE)
+  {
+    // drain fd
+    uint64_t discard;
+    std::size_t n = ::read(ring.wake_fd, &discard, sizeof(discard));
+    (void)n;
+
+    return true;
+  }
+
+  return false;
+}
+
+bool IoUring::ev_close(const event_t &ev) noexcept
+{
+  return (ev.events & POLLHUP) != 0;
+}
+
+bool IoUring::ev_error(const event_t &ev) noexcept
+{
+  return (ev.events & POLLERR) != 0;
+}
+
+bool IoUring::ev_readable(const event_t &ev) noexcept
+{
+  return (ev.events & POLLIN) != 0;
+}
+
+bool IoUring::ev_writeable(const event_t &ev) noexcept
+{
+  return (ev.events & POLLOUT) != 0;
+}
+
+void *IoUring::get_user_data(const event_t &ev) noexcept { return ev.ptr; }
+
+/* event subscriptions */
+
+void IoUring::subscribe(
+  void *ptr, fd_t fd, bool want_read, bool want_write
+) noexcept
+{
+  Socket *s = lookup(fd);
+  if (!s)
+  {
+    return;
+  }
+
+  s->ptr = ptr;
+
+  // (an armed recv keeps queueing, it is not cancelled without want_read)
+  if (want_read)
+  {
+    if (!s->recv_armed && !s->starved && !s->eof && s->err == 0)
+    {
+      arm_recv(fd, *s);
+    }
+
+    // like re-arming an edge-triggered epoll: report what is pending
+    if (has_input(*s))
+    {
+      mark(fd, *s, POLLIN);
+    }
+  }
+
+  if (want_write && !s->pollout_armed)
+  {
+    arm_pollout(fd, *s);
+  }
+}
+
+void IoUring::clear(fd_t fd) noexcept { release(fd); }
+
+} // namespace manet::net
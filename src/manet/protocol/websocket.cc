@@ -19,50 +19,96 @@ void random_bytes(std::byte *buf, std::size_t len) noexcept
   }
 }
 
-Handshake make_handshake(
+RequestTemplate compile_request(
   std::string_view host, std::string_view path,
   std::span<const websocket::Header> extra
 ) noexcept
 {
-  // generate nonce
-  std::array<std::byte, 16> nonce{};
-  random_bytes(nonce.data(), nonce.size());
+  RequestTemplate request;
+
+  std::size_t len = 0;
+  bool fits = true;
 
-  std::array<char, 24> key_b64{};
-  utils::base64_encode<16, 24>(nonce, key_b64);
+  auto append = [&](std::string_view sv)
+  {
+    if (RequestTemplate::CAP < len + sv.size())
+    {
+      fits = false;
+      return;
+    }
 
-  std::string req;
-  req.reserve(512);
+    std::memcpy(request.buf.data() + len, sv.data(), sv.size());
+    len += sv.size();
+  };
 
   // build request line & headers
-  // clang-format off
-  std::format_to(
-    std::back_inserter(req),
-    "GET {} HTTP/1.1\r\n"
-    "Host: {}\r\n"
-    "Upgrade: websocket\r\n"
-    "Connection: Upgrade\r\n"
-    "Sec-WebSocket-Key: {}\r\n"
-    "Sec-WebSocket-Version: 13\r\n",
-    path, host,
-    std::string_view(
-      reinterpret_cast<const char *>(key_b64.data()), key_b64.size()
-    )
-  );
-  // clang-format on
+  append("GET ");
+  append(path);
+  append(" HTTP/1.1\r\n"
+         "Host: ");
+  append(host);
+  append("\r\n"
+         "Upgrade: websocket\r\n"
+         "Connection: Upgrade\r\n"
+         "Sec-WebSocket-Key: ");
+
+  // hole for the base64 nonce (filled by `write_request`)
+  request.key_offset = len;
+  constexpr std::string_view key_hole = "????????????????????????";
+  static_assert(key_hole.size() == RequestTemplate::KEY_LEN);
+
+  append(key_hole);
+
+  append("\r\n"
+         "Sec-WebSocket-Version: 13\r\n");
 
   for (const auto &h : extra)
   {
     if (!h.name.empty())
     {
-      std::format_to(std::back_inserter(req), "{}: {}\r\n", h.name, h.value);
+      append(h.name);
+      append(": ");
+      append(h.value);
+      append("\r\n");
     }
   }
-  req.append("\r\n");
+  append("\r\n");
+
+  if (!fits)
+  {
+    log::error("upgrade request exceeds {} bytes", RequestTemplate::CAP);
+    len = 0;
+  }
+
+  request.len = len;
+
+  return request;
+}
+
+std::size_t write_request(
+  RequestTemplate &request, std::span<std::byte> output,
+  std::array<char, 28> &ws_accept_key
+) noexcept
+{
+  if (request.len == 0 || output.size() < request.len)
+  {
+    return 0;
+  }
+
+  // generate nonce
+  std::array<std::byte, 16> nonce{};
+  random_bytes(nonce.data(), nonce.size());
+
+  std::array<char, RequestTemplate::KEY_LEN> key_b64{};
+  utils::base64_encode<16, RequestTemplate::KEY_LEN>(nonce, key_b64);
+
+  std::memcpy(
+    request.buf.data() + request.key_offset, key_b64.data(), key_b64.size()
+  );
 
   // Sec-WebSocket-Accept = base64( SHA1( key_b64 ; GUID ) )
-  std::array<uint8_t, 24 + 36> scratch{};
   static constexpr char kGuid[] = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+  std::array<uint8_t, RequestTemplate::KEY_LEN + sizeof(kGuid) - 1> scratch;
 
   // key_b64
   std::memcpy(scratch.data(), key_b64.data(), key_b64.size());
@@ -72,156 +118,213 @@ Handshake make_handshake(
   // SHA1( scratch )
   std::array<std::byte, 20> sha1{};
   SHA1(
-    scratch.data(), key_b64.size() + (sizeof(kGuid) - 1),
-    reinterpret_cast<uint8_t *>(sha1.data())
+    scratch.data(), scratch.size(), reinterpret_cast<uint8_t *>(sha1.data())
   );
 
   // base64(20) -> 28
-  std::array<char, 28> accept{};
-  utils::base64_encode(sha1, accept);
+  utils::base64_encode(sha1, ws_accept_key);
+
+  std::memcpy(output.data(), request.buf.data(), request.len);
 
-  return Handshake{.upgrade_request = std::move(req), .ws_accept_key = accept};
+  return request.len;
 }
 
-/** counter:
- * - 0: ()
- * - 1: (\r)
- * - 2: (\r\n)
- * - 3: (\r\n\r)
- * - 4: (\r\n\r\n)
- */
-uint8_t advance_crlf_count(uint8_t crlf_counter, std::byte chr)
+namespace
+{
+
+constexpr std::array<std::string_view, 3> field_names = {
+  "Sec-WebSocket-Accept",
+  "Sec-WebSocket-Extensions",
+  "Sec-WebSocket-Protocol",
+};
+
+/** ASCII case-insensitive compare (header names are tokens) */
+bool iequals(std::string_view a, std::string_view b) noexcept
 {
-  if (chr == std::byte{'\r'})
+  if (a.size() != b.size())
   {
-    return crlf_counter + (crlf_counter % 2 == 0 ? 1 : 0);
+    return false;
   }
-  else if (chr == std::byte{'\n'})
+
+  for (std::size_t i = 0; i < a.size(); i++)
   {
-    return crlf_counter + (crlf_counter % 2);
+    if ((a[i] | 0x20) != (b[i] | 0x20))
+    {
+      return false;
+    }
   }
-  else
+
+  return true;
+}
+
+/** `HTTP-Version SP Status-Code SP Reason-Phrase` -> Status-Code (0 if
+ * malformed) */
+uint16_t parse_status_line(std::string_view line) noexcept
+{
+  auto sp = line.find(' ');
+  if (sp == std::string_view::npos || line.size() < sp + 4)
   {
     return 0;
   }
+
+  uint16_t code = 0;
+  for (std::size_t i = sp + 1; i < sp + 4; i++)
+  {
+    if (line[i] < '0' || '9' < line[i])
+    {
+      return 0;
+    }
+    code = code * 10 + (line[i] - '0');
+  }
+
+  return code;
 }
 
-Status read_handshake(
-  std::array<char, 28> ws_accept_key, reactor::RxSource in
+/** `field-name ":" OWS field-value OWS` (at offset `pos` of the response) */
+void parse_header_line(
+  HandshakeParser &parser, std::string_view line, std::size_t pos
 ) noexcept
 {
-  auto input = in.rbuf();
-
-  // establish indices (HTTP response code, Sec-WebSocket-Accept header, HTTP
-  // response end)
-  uint8_t crlf_counter = 0;
-  std::size_t sp_ix = 0;
-  std::size_t ws_key_start = 0;
+  auto colon = line.find(':');
+  if (colon == std::string_view::npos)
+  {
+    return;
+  }
 
-  std::size_t i = 0;
+  auto name = line.substr(0, colon);
 
-  for (std::byte chr : input)
+  for (std::size_t f = 0; f < field_names.size(); f++)
   {
-    if (sp_ix == 0 && chr == std::byte{' '})
+    if (!iequals(name, field_names[f]))
     {
-      sp_ix = i;
+      continue;
     }
 
-    // after a \r\n (crlf_counter == 2)
-    constexpr std::string_view h = "Sec-WebSocket-Accept:";
+    std::size_t begin = colon + 1;
+    std::size_t end = line.size();
 
-    if (ws_key_start == 0 && crlf_counter == 2 && chr == std::byte{'S'} &&
-        i + h.size() < input.size())
+    while (begin < end && (line[begin] == ' ' || line[begin] == '\t'))
+    {
+      begin++;
+    }
+    while (begin < end && (line[end - 1] == ' ' || line[end - 1] == '\t'))
     {
-      // check for Sec-WebSocket-Accept
-      auto sv = std::string_view(
-        reinterpret_cast<const char *>(input.data()) + i, h.size()
-      );
-
-      if (std::equal(
-            sv.begin(), sv.end(), h.begin(), h.end(),
-            [](unsigned char a, unsigned char b)
-            { return std::tolower(a) == std::tolower(b); }
-          ))
+      end--;
+    }
+
+    parser.fields[f] = {
+      .offset = static_cast<uint32_t>(pos + begin),
+      .len = static_cast<uint32_t>(end - begin),
+      .found = true
+    };
+
+    return;
+  }
+}
+
+} // namespace
+
+Status read_handshake(
+  HandshakeParser &parser, std::array<char, 28> ws_accept_key,
+  reactor::RxSource in
+) noexcept
+{
+  auto input = in.rbuf();
+  const char *base = reinterpret_cast<const char *>(input.data());
+
+  // walk complete lines (memchr is vectorized), resuming where we left off
+  std::size_t end = 0;
+
+  while (end == 0)
+  {
+    const void *nl =
+      std::memchr(base + parser.scan, '\n', input.size() - parser.scan);
+
+    if (nl == nullptr)
+    {
+      if (HandshakeParser::MAX_RESPONSE < input.size())
       {
-        // found the header starting at i, seek index of value (skip SP)
-        ws_key_start = i + h.size();
-        for (; input[ws_key_start] == std::byte{' '}; ws_key_start++)
-          ;
+        log::error("invalid HTTP response: too large.");
+        return Status::error;
       }
+
+      log::trace("invalid HTTP response: unexpected end.");
+      return Status::ok; // without consuming -> on_data again
     }
 
-    // count through \r\n\r\n
-    crlf_counter = advance_crlf_count(crlf_counter, chr);
+    std::size_t eol = static_cast<const char *>(nl) - base;
+    std::size_t line_end =
+      (parser.scan < eol && base[eol - 1] == '\r') ? eol - 1 : eol;
+
+    std::string_view line(base + parser.scan, line_end - parser.scan);
 
-    // hit \r\n\r\n  -> we read the complete HTTP message
-    if (crlf_counter == 4)
+    if (!parser.status_line)
+    {
+      parser.status_line = true;
+      parser.status = parse_status_line(line);
+    }
+    else if (line.empty())
+    {
+      end = eol + 1; // hit \r\n\r\n -> we read the complete HTTP message
+    }
+    else
     {
-      break;
+      parse_header_line(parser, line, parser.scan);
     }
 
-    i++;
+    parser.scan = eol + 1;
   }
 
   // dump response
   if constexpr (log::enabled)
   {
-    std::string_view sv(reinterpret_cast<const char *>(input.data()), i + 1);
-    log::trace("WebSocket handshake:\n{}", sv);
+    log::trace("WebSocket handshake:\n{}", std::string_view(base, end));
   }
 
   // validate the HTTP response:
 
-  if (crlf_counter != 4)
+  using Field = HandshakeParser::Field;
+
+  auto got_sv = parser.value(Field::accept, input);
+  auto expect_sv = std::string_view(ws_accept_key.data(), ws_accept_key.size());
+
+  if (parser[Field::extensions].found)
+  {
+    log::trace(
+      "Sec-WebSocket-Extensions: {}", parser.value(Field::extensions, input)
+    );
+  }
+
+  if (parser[Field::protocol].found)
   {
-    log::trace("invalid HTTP response: unexpected end.");
-    return Status::ok; // without consuming -> on_data again
+    log::trace(
+      "Sec-WebSocket-Protocol: {}", parser.value(Field::protocol, input)
+    );
   }
 
-  // we consumed (i+1) bytes!
-  in.read(i + 1);
+  // we consumed the complete HTTP message (this only moves the read cursor,
+  // the views above stay valid)
+  in.read(end);
 
-  if (sp_ix == 0 || input.size() <= sp_ix + 3)
+  if (parser.status == 0)
   {
     log::error("invalid HTTP response: status line.");
     return Status::error;
   }
 
   // make sure we got `HTTP-Version SP 101...`
-  if (input[sp_ix + 1] != std::byte{'1'} ||
-      input[sp_ix + 2] != std::byte{'0'} || input[sp_ix + 3] != std::byte{'1'})
+  if (parser.status != 101)
   {
-    log::error(
-      "HTTP error: {}{}{}", static_cast<char>(input[sp_ix + 1]),
-      static_cast<char>(input[sp_ix + 2]), static_cast<char>(input[sp_ix + 3])
-    );
+    log::error("HTTP error: {}", parser.status);
     return Status::error;
   }
 
-  if (ws_key_start == 0)
+  if (!parser[Field::accept].found)
   {
     log::error("WebSocket error: missing Sec-WebSocket-Accept header");
+    return Status::error;
   }
 
-  // determine end of Sec-WebSocket-Accept key
-  std::size_t ws_key_end = ws_key_start;
-  while (ws_key_end < input.size() && input[ws_key_end] != std::byte{'\r'} &&
-         input[ws_key_end] != std::byte{'\n'})
-  {
-    ws_key_end++;
-  }
-
-  std::span<const std::byte> got = input.subspan(ws_key_start, 28);
-
-  auto got_sv = std::string_view(
-    reinterpret_cast<const char *>(input.data()) + ws_key_start,
-    ws_key_end - ws_key_start
-  );
-
-  auto expect_sv = std::string_view(
-    reinterpret_cast<const char *>(ws_accept_key.data()), ws_accept_key.size()
-  );
-
   if (got_sv != expect_sv)
   {
     log::error(
@@ -234,6 +337,14 @@ Status read_handshake(
   return Status::ok;
 }
 
+Status read_handshake(
+  std::array<char, 28> ws_accept_key, reactor::RxSource in
+) noexcept
+{
+  HandshakeParser parser{};
+  return read_handshake(parser, ws_accept_key, in);
+}
+
 /** write a control frame (CLOSE,PING,PONG; payload length <= 125 bytes) */
 std::size_t write_control_frame(
   std::span<std::byte> output, OpCode opcode, std::span<const std::byte> payload
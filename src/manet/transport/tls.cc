@@ -1,3 +1,6 @@
+#include <cerrno>
+#include <unistd.h>
+
 #include "manet/transport/tls.hpp"
 #include "manet/transport/status.hpp"
 
@@ -6,6 +9,13 @@ namespace manet::transport::tls::detail
 
 Status TlsEndpoint::handshake_step() noexcept
 {
+  using clock = std::chrono::steady_clock;
+
+  if (handshake_start == clock::time_point{})
+  {
+    handshake_start = clock::now();
+  }
+
   int r = SSL_connect(ssl_ctx);
   if (r != 1)
   {
@@ -32,13 +42,105 @@ Status TlsEndpoint::handshake_step() noexcept
           "verify_result={} ({})", v, X509_verify_cert_error_string(v)
         );
       }
+
+      // do not offer a (possibly rejected) session again
+      forget_session(ssl_ctx, host);
+
+      failed = true;
       return Status::error;
     }
   }
 
+  auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+    clock::now() - handshake_start
+  );
+
+  auto &s = stats();
+  s.handshake_ns.record(static_cast<uint64_t>(elapsed.count()));
+
+  if (SSL_session_reused(ssl_ctx))
+  {
+    s.resumed++;
+  }
+  else
+  {
+    s.full++;
+  }
+
+  switch (SSL_get_early_data_status(ssl_ctx))
+  {
+  case SSL_EARLY_DATA_ACCEPTED:
+    s.early_accepted++;
+    break;
+  case SSL_EARLY_DATA_REJECTED:
+    s.early_rejected++;
+    break;
+  default:
+    break;
+  }
+
+  log::trace(
+    "TLS handshake ({}, {}ns)", SSL_session_reused(ssl_ctx) ? "resumed" : "full",
+    elapsed.count()
+  );
+
+#ifndef OPENSSL_NO_KTLS
+  if constexpr (ktls_enabled)
+  {
+    ktls_tx = BIO_get_ktls_send(SSL_get_wbio(ssl_ctx));
+    ktls_rx = BIO_get_ktls_recv(SSL_get_rbio(ssl_ctx));
+
+    s.ktls_tx += ktls_tx;
+    s.ktls_rx += ktls_rx;
+
+    log::info("kTLS ({}): tx={}, rx={}", host, ktls_tx, ktls_rx);
+  }
+#endif
+
   return Status::ok;
 }
 
+bool TlsEndpoint::early_data() const noexcept
+{
+  const SSL_SESSION *session = SSL_get0_session(ssl_ctx);
+  return early && session && SSL_SESSION_get_max_early_data(session) > 0;
+}
+
+Status TlsEndpoint::early_write(
+  std::span<const std::byte> data, std::size_t &written
+) noexcept
+{
+  if (handshake_start == std::chrono::steady_clock::time_point{})
+  {
+    handshake_start = std::chrono::steady_clock::now();
+  }
+
+  int r = SSL_write_early_data(ssl_ctx, data.data(), data.size(), &written);
+  if (r == 1)
+  {
+    return Status::ok;
+  }
+
+  int err = SSL_get_error(ssl_ctx, r);
+  if (err == SSL_ERROR_WANT_READ)
+  {
+    return Status::want_read;
+  }
+
+  if (err == SSL_ERROR_WANT_WRITE)
+  {
+    return Status::want_write;
+  }
+
+  failed = true;
+  return Status::error;
+}
+
+bool TlsEndpoint::early_accepted() const noexcept
+{
+  return SSL_get_early_data_status(ssl_ctx) == SSL_EARLY_DATA_ACCEPTED;
+}
+
 Status TlsEndpoint::read(reactor::RxSink in) noexcept
 {
   constexpr auto max_int_size_t =
@@ -48,18 +150,81 @@ Status TlsEndpoint::read(reactor::RxSink in) noexcept
   const auto sz =
     in.wbuf().size() < max_int_size_t ? in.wbuf().size() : max_int_size_t;
 
+  // the kernel decrypts: plain read unless SSL still buffers a record
+  if (ktls_rx && SSL_pending(ssl_ctx) == 0)
+  {
+    while (true)
+    {
+      ssize_t n = ::read(fd, in.wbuf().data(), sz);
+      if (n > 0)
+      {
+        in.wrote(static_cast<std::size_t>(n));
+        return short_read_drained && static_cast<std::size_t>(n) < sz
+                 ? Status::want_read
+                 : Status::ok;
+      }
+
+      if (n == 0)
+      {
+        return Status::close;
+      }
+
+      if (errno == EINTR)
+      {
+        continue;
+      }
+
+      if (errno == EAGAIN || errno == EWOULDBLOCK)
+      {
+        return Status::want_read;
+      }
+
+      // EIO: next record is not application data (alert, post-handshake
+      // message), SSL_read picks it up with its control message
+      if (errno == EIO)
+      {
+        break;
+      }
+
+      failed = true;
+      return Status::error;
+    }
+  }
+
   const int len = SSL_read(ssl_ctx, in.wbuf().data(), static_cast<int>(sz));
   if (len > 0)
   {
+    stats().records++;
     in.wrote(len);
+
+    // the socket was drained by the last read and SSL buffers nothing else
+    if (short_read_drained && !SSL_has_pending(ssl_ctx) &&
+        bio_drained(SSL_get_rbio(ssl_ctx)))
+    {
+      return Status::want_read;
+    }
+
     return Status::ok;
   }
 
   const int err = SSL_get_error(ssl_ctx, len);
-  return err == SSL_ERROR_WANT_READ     ? Status::want_read
-         : err == SSL_ERROR_WANT_WRITE  ? Status::want_write
-         : err == SSL_ERROR_ZERO_RETURN ? Status::close
-                                        : Status::error;
+  if (err == SSL_ERROR_WANT_READ)
+  {
+    return Status::want_read;
+  }
+
+  if (err == SSL_ERROR_WANT_WRITE)
+  {
+    return Status::want_write;
+  }
+
+  if (err == SSL_ERROR_ZERO_RETURN)
+  {
+    return Status::close;
+  }
+
+  failed = true;
+  return Status::error;
 }
 
 Status TlsEndpoint::write(reactor::TxSource out) noexcept
@@ -67,8 +232,36 @@ Status TlsEndpoint::write(reactor::TxSource out) noexcept
   constexpr auto max_int_size_t =
     static_cast<std::size_t>(std::numeric_limits<int>::max());
 
-  const auto sz =
-    out.rbuf().size() < max_int_size_t ? out.rbuf().size() : max_int_size_t;
+  const auto limit =
+    0 < max_write && max_write < max_int_size_t ? max_write : max_int_size_t;
+  const auto sz = out.rbuf().size() < limit ? out.rbuf().size() : limit;
+
+  // the kernel encrypts and frames application data records
+  if (ktls_tx)
+  {
+    while (true)
+    {
+      ssize_t n = ::write(fd, out.rbuf().data(), sz);
+      if (n > 0)
+      {
+        out.read(static_cast<std::size_t>(n));
+        return Status::ok;
+      }
+
+      if (n < 0 && errno == EINTR)
+      {
+        continue;
+      }
+
+      if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+      {
+        return Status::want_write;
+      }
+
+      failed = true;
+      return Status::error;
+    }
+  }
 
   const int len = SSL_write(ssl_ctx, out.rbuf().data(), static_cast<int>(sz));
   if (len > 0)
@@ -78,10 +271,23 @@ Status TlsEndpoint::write(reactor::TxSource out) noexcept
   }
 
   const int err = SSL_get_error(ssl_ctx, len);
-  return err == SSL_ERROR_WANT_READ     ? Status::want_read
-         : err == SSL_ERROR_WANT_WRITE  ? Status::want_write
-         : err == SSL_ERROR_ZERO_RETURN ? Status::close
-                                        : Status::error;
+  if (err == SSL_ERROR_WANT_READ)
+  {
+    return Status::want_read;
+  }
+
+  if (err == SSL_ERROR_WANT_WRITE)
+  {
+    return Status::want_write;
+  }
+
+  if (err == SSL_ERROR_ZERO_RETURN)
+  {
+    return Status::close;
+  }
+
+  failed = true;
+  return Status::error;
 }
 
 Status TlsEndpoint::shutdown_step() noexcept
@@ -94,14 +300,12 @@ Status TlsEndpoint::shutdown_step() noexcept
     return Status::ok;
   }
 
-  /* // half-closed: we close_notify the server but have not heard back
+  // half-closed: close_notify is sent and the socket is closed next, no need
+  // to wait for the peer's (SSL_get_error would report SYSCALL here)
   if (r == 0)
   {
-    int w = SSL_want(ctx);
-    bool write = w & SSL_WRITING;
-    // SSL_shutdown just sent close_notify, so probably we want READ
-    return write ? Status::want_write : Status::want_read;
-  } */
+    return Status::ok;
+  }
 
   int e = SSL_get_error(ssl_ctx, r);
 
@@ -120,6 +324,7 @@ Status TlsEndpoint::shutdown_step() noexcept
     return Status::want_read;
   }
 
+  failed = true;
   return Status::error;
 }
 
@@ -127,7 +332,20 @@ void TlsEndpoint::destroy() noexcept
 {
   if (ssl_ctx)
   {
-    SSL_free(ssl_ctx);
+    // OpenSSL invalidates the session of connections freed without
+    // close_notify, a dropped connection should still resume (and 0-RTT).
+    // not after an error though: the session may be the reason
+    if (!failed)
+    {
+      SSL_set_shutdown(ssl_ctx, SSL_SENT_SHUTDOWN);
+    }
+
+    if (!pool || !release_ssl(ssl_ctx, pool, host))
+    {
+      SSL_free(ssl_ctx);
+    }
+
+    ssl_ctx = nullptr;
   }
 }
 
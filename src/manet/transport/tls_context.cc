@@ -0,0 +1,422 @@
+#include <array>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <openssl/err.h>
+#include <openssl/evp.h>
+#include <openssl/x509.h>
+
+#include "manet/logging.hpp"
+#include "manet/transport/tls_context.hpp"
+#include "manet/transport/tls_session.hpp"
+
+namespace manet::transport::tls::detail
+{
+
+namespace
+{
+
+/** size of the read-ahead buffer (several max. sized records) */
+constexpr long READ_AHEAD = 1 << 16;
+
+struct Context
+{
+  SSL_CTX *ctx = nullptr;
+
+  bool chain = true; // verify the chain (otw. the pin alone)
+  std::array<unsigned char, 32> pin{};
+
+  ~Context()
+  {
+    if (ctx)
+    {
+      SSL_CTX_free(ctx);
+    }
+  }
+};
+
+// (never destroyed: g_tls_free runs at exit after function-local statics
+// constructed later than its registration are gone)
+std::unordered_map<std::string, std::unique_ptr<Context>> &contexts() noexcept
+{
+  static auto &cache =
+    *new std::unordered_map<std::string, std::unique_ptr<Context>>;
+  return cache;
+}
+
+/** idle SSLs of one context, BIO method and host */
+struct Pool
+{
+  static constexpr std::size_t CAP = 8;
+
+  SSL_CTX *ctx;
+  const BIO_METHOD *method;
+  std::string host;
+  std::vector<SSL *> idle;
+};
+
+std::vector<Pool> &pools() noexcept
+{
+  static auto &pools = *new std::vector<Pool>;
+  return pools;
+}
+
+Pool *
+find_pool(SSL_CTX *ctx, const BIO_METHOD *method, const char *host) noexcept
+{
+  for (auto &pool : pools())
+  {
+    if (pool.ctx == ctx && pool.method == method && pool.host == host)
+    {
+      return &pool;
+    }
+  }
+
+  return nullptr;
+}
+
+std::string key(const TlsConfig &config)
+{
+  std::string k;
+
+  for (const char *field :
+       {config.ciphersuites, config.cipher_list, config.groups, config.alpn,
+        config.ca_file, config.spki_pin, config.cert_file, config.key_file})
+  {
+    // distinguish unset from empty
+    if (field)
+    {
+      k += '+';
+      k += field;
+    }
+    k += '\0';
+  }
+
+  return k;
+}
+
+void log_error(const char *what) noexcept
+{
+  if constexpr (log::enabled)
+  {
+    unsigned long e = ERR_get_error();
+    log::error("{} failed: {}", what, ERR_error_string(e, nullptr));
+  }
+}
+
+/** "h2,http/1.1" -> "\x02h2\x08http/1.1" */
+std::string alpn_protos(const char *alpn)
+{
+  std::string wire;
+
+  for (const char *p = alpn; *p;)
+  {
+    std::size_t len = std::strcspn(p, ",");
+    if (0 < len && len < 256)
+    {
+      wire += static_cast<char>(len);
+      wire.append(p, len);
+    }
+
+    p += len;
+    if (*p == ',')
+    {
+      p++;
+    }
+  }
+
+  return wire;
+}
+
+bool decode_pin(const char *pin, std::array<unsigned char, 32> &out) noexcept
+{
+  // 32 bytes are 44 base64 characters (one '=' padding)
+  if (std::strlen(pin) != 44 || pin[43] != '=')
+  {
+    return false;
+  }
+
+  std::array<unsigned char, 33> buf{};
+  const auto *in = reinterpret_cast<const unsigned char *>(pin);
+  if (EVP_DecodeBlock(buf.data(), in, 44) != 33)
+  {
+    return false;
+  }
+
+  std::memcpy(out.data(), buf.data(), out.size());
+  return true;
+}
+
+bool spki_matches(X509 *leaf, const std::array<unsigned char, 32> &pin)
+{
+  unsigned char *der = nullptr;
+  int len = i2d_X509_PUBKEY(X509_get_X509_PUBKEY(leaf), &der);
+  if (len <= 0)
+  {
+    return false;
+  }
+
+  std::array<unsigned char, 32> md{};
+  unsigned int md_len = 0;
+  bool ok = EVP_Digest(der, len, md.data(), &md_len, EVP_sha256(), nullptr) &&
+            md_len == md.size() && md == pin;
+
+  OPENSSL_free(der);
+  return ok;
+}
+
+int verify_pinned(X509_STORE_CTX *store, void *arg)
+{
+  const auto *context = static_cast<const Context *>(arg);
+
+  if (context->chain && X509_verify_cert(store) != 1)
+  {
+    return 0;
+  }
+
+  X509 *leaf = X509_STORE_CTX_get0_cert(store);
+  if (!leaf || !spki_matches(leaf, context->pin))
+  {
+    log::error("TLS peer key does not match the SPKI pin");
+
+    X509_STORE_CTX_set_error(store, X509_V_ERR_APPLICATION_VERIFICATION);
+    return 0;
+  }
+
+  return 1;
+}
+
+bool configure(Context &context, const TlsConfig &config)
+{
+  SSL_CTX *ctx = context.ctx;
+
+  // trust store: pinned bundle, otw. the system's
+  if (config.ca_file)
+  {
+    if (SSL_CTX_load_verify_locations(ctx, config.ca_file, nullptr) != 1)
+    {
+      log_error("SSL_CTX_load_verify_locations");
+      return false;
+    }
+  }
+  else if (!config.spki_pin && SSL_CTX_set_default_verify_paths(ctx) != 1)
+  {
+    log_error("SSL_CTX_set_default_verify_paths");
+    return false;
+  }
+
+  if (config.spki_pin)
+  {
+    if (!decode_pin(config.spki_pin, context.pin))
+    {
+      log::error("invalid SPKI pin: {}", config.spki_pin);
+      return false;
+    }
+
+    context.chain = config.ca_file != nullptr;
+    SSL_CTX_set_cert_verify_callback(ctx, &verify_pinned, &context);
+  }
+
+  // require at least TLS 1.2
+  SSL_CTX_set_min_proto_version(ctx, TLS1_2_VERSION);
+
+  const char *suites =
+    config.ciphersuites ? config.ciphersuites : default_ciphersuites();
+  if (SSL_CTX_set_ciphersuites(ctx, suites) != 1)
+  {
+    log_error("SSL_CTX_set_ciphersuites");
+    return false;
+  }
+
+  if (config.cipher_list &&
+      SSL_CTX_set_cipher_list(ctx, config.cipher_list) != 1)
+  {
+    log_error("SSL_CTX_set_cipher_list");
+    return false;
+  }
+
+  if (config.groups && SSL_CTX_set1_groups_list(ctx, config.groups) != 1)
+  {
+    log_error("SSL_CTX_set1_groups_list");
+    return false;
+  }
+
+  if (config.alpn)
+  {
+    auto wire = alpn_protos(config.alpn);
+
+    // (0 is success here)
+    if (SSL_CTX_set_alpn_protos(
+          ctx, reinterpret_cast<const unsigned char *>(wire.data()),
+          static_cast<unsigned int>(wire.size())
+        ) != 0)
+    {
+      log_error("SSL_CTX_set_alpn_protos");
+      return false;
+    }
+  }
+
+  if (config.cert_file || config.key_file)
+  {
+    if (!config.cert_file || !config.key_file)
+    {
+      log::error("client certificate needs both cert_file and key_file");
+      return false;
+    }
+
+    if (SSL_CTX_use_certificate_chain_file(ctx, config.cert_file) != 1)
+    {
+      log_error("SSL_CTX_use_certificate_chain_file");
+      return false;
+    }
+
+    if (SSL_CTX_use_PrivateKey_file(ctx, config.key_file, SSL_FILETYPE_PEM) !=
+        1)
+    {
+      log_error("SSL_CTX_use_PrivateKey_file");
+      return false;
+    }
+
+    if (SSL_CTX_check_private_key(ctx) != 1)
+    {
+      log_error("SSL_CTX_check_private_key");
+      return false;
+    }
+  }
+
+  // read as much as available into OpenSSL's record buffer instead of a
+  // read for each record header and body
+  SSL_CTX_set_read_ahead(ctx, 1);
+  SSL_CTX_set_default_read_buffer_len(ctx, READ_AHEAD);
+
+  // client session cache (resumption across reconnects), we keep the
+  // sessions ourselves (see tls_session.hpp)
+  SSL_CTX_set_session_cache_mode(
+    ctx, SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE
+  );
+  SSL_CTX_sess_set_new_cb(ctx, &cache_session);
+
+  return true;
+}
+
+} // namespace
+
+const char *default_ciphersuites() noexcept
+{
+  static const char *suites = []
+  {
+#if defined(__x86_64__) || defined(__i386__)
+    bool aes = __builtin_cpu_supports("aes");
+#else
+    bool aes = true; // assume AES instructions (ARMv8 crypto extensions)
+#endif
+
+    return aes ? "TLS_AES_128_GCM_SHA256:TLS_AES_256_GCM_SHA384:"
+                 "TLS_CHACHA20_POLY1305_SHA256"
+               : "TLS_CHACHA20_POLY1305_SHA256:TLS_AES_128_GCM_SHA256:"
+                 "TLS_AES_256_GCM_SHA384";
+  }();
+
+  return suites;
+}
+
+SSL_CTX *context(const TlsConfig &config) noexcept
+{
+  try
+  {
+    auto &cache = contexts();
+
+    auto k = key(config);
+    if (auto it = cache.find(k); it != cache.end())
+    {
+      return it->second->ctx;
+    }
+
+    auto context = std::make_unique<Context>();
+
+    context->ctx = SSL_CTX_new(TLS_client_method());
+    if (!context->ctx)
+    {
+      log_error("SSL_CTX_new");
+      return nullptr;
+    }
+
+    if (!configure(*context, config))
+    {
+      return nullptr;
+    }
+
+    return cache.emplace(k, std::move(context)).first->second->ctx;
+  }
+  catch (...)
+  {
+    log::error("cannot create SSL_CTX");
+    return nullptr;
+  }
+}
+
+SSL *acquire_ssl(
+  SSL_CTX *ctx, const BIO_METHOD *method, const char *host
+) noexcept
+{
+  Pool *pool = find_pool(ctx, method, host);
+  if (!pool || pool->idle.empty())
+  {
+    return nullptr;
+  }
+
+  SSL *ssl = pool->idle.back();
+  pool->idle.pop_back();
+  return ssl;
+}
+
+bool release_ssl(
+  SSL *ssl, const BIO_METHOD *method, const char *host
+) noexcept
+{
+  try
+  {
+    SSL_CTX *ctx = SSL_get_SSL_CTX(ssl);
+
+    Pool *pool = find_pool(ctx, method, host);
+    if (!pool)
+    {
+      pool = &pools().emplace_back(
+        Pool{.ctx = ctx, .method = method, .host = host, .idle = {}}
+      );
+      pool->idle.reserve(Pool::CAP);
+    }
+
+    if (Pool::CAP <= pool->idle.size() || SSL_clear(ssl) != 1)
+    {
+      return false;
+    }
+
+    pool->idle.push_back(ssl);
+    return true;
+  }
+  catch (...)
+  {
+    return false;
+  }
+}
+
+void free_contexts() noexcept
+{
+  // (pooled SSLs hold a reference to their context)
+  for (auto &pool : pools())
+  {
+    for (SSL *ssl : pool.idle)
+    {
+      SSL_free(ssl);
+    }
+  }
+
+  pools().clear();
+  contexts().clear();
+}
+
+} // namespace manet::transport::tls::detail
@@ -0,0 +1,190 @@
+#include <cstdint>
+#include <ctime>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "manet/logging.hpp"
+#include "manet/transport/tls_session.hpp"
+
+namespace manet::transport::tls
+{
+
+Stats &stats() noexcept
+{
+  static Stats s;
+  return s;
+}
+
+namespace detail
+{
+
+namespace
+{
+
+/** host and port of a session (looked up without a copy of the host) */
+struct Peer
+{
+  std::string host;
+  uint16_t port;
+};
+
+struct PeerView
+{
+  std::string_view host;
+  uint16_t port;
+};
+
+struct PeerHash
+{
+  using is_transparent = void;
+
+  std::size_t operator()(PeerView peer) const noexcept
+  {
+    return std::hash<std::string_view>{}(peer.host) ^
+           static_cast<std::size_t>(peer.port) * 0x9e3779b97f4a7c15ull;
+  }
+
+  std::size_t operator()(const Peer &peer) const noexcept
+  {
+    return (*this)(PeerView{peer.host, peer.port});
+  }
+};
+
+struct PeerEqual
+{
+  using is_transparent = void;
+
+  static PeerView view(PeerView peer) noexcept { return peer; }
+  static PeerView view(const Peer &peer) noexcept
+  {
+    return {peer.host, peer.port};
+  }
+
+  template <typename A, typename B>
+  bool operator()(const A &a, const B &b) const noexcept
+  {
+    return view(a).host == view(b).host && view(a).port == view(b).port;
+  }
+};
+
+using host_sessions_t =
+  std::unordered_map<Peer, SSL_SESSION *, PeerHash, PeerEqual>;
+
+// per SSL_CTX: a session is only offered under the config (trust store, SPKI
+// pin) it was verified with, as resuming skips certificate verification
+// (never destroyed, see contexts() in tls_context.cc)
+std::unordered_map<const SSL_CTX *, host_sessions_t> &sessions() noexcept
+{
+  static auto &cache =
+    *new std::unordered_map<const SSL_CTX *, host_sessions_t>;
+  return cache;
+}
+
+/** the port an SSL connects to (set by `resume_session`) */
+int port_index() noexcept
+{
+  static int index =
+    SSL_get_ex_new_index(0, nullptr, nullptr, nullptr, nullptr);
+  return index;
+}
+
+PeerView peer(SSL *ssl, const char *host) noexcept
+{
+  auto port =
+    reinterpret_cast<std::uintptr_t>(SSL_get_ex_data(ssl, port_index()));
+  return {host, static_cast<uint16_t>(port)};
+}
+
+bool expired(const SSL_SESSION *session) noexcept
+{
+  return SSL_SESSION_get_time(session) + SSL_SESSION_get_timeout(session) <=
+         static_cast<long>(std::time(nullptr));
+}
+
+} // namespace
+
+int cache_session(SSL *ssl, SSL_SESSION *session) noexcept
+{
+  const char *host = SSL_get_servername(ssl, TLSEXT_NAMETYPE_host_name);
+  if (!host || !SSL_SESSION_is_resumable(session))
+  {
+    return 0; // not retained
+  }
+
+  auto &cache = sessions()[SSL_get_SSL_CTX(ssl)];
+  auto key = peer(ssl, host);
+
+  if (auto it = cache.find(key); it != cache.end())
+  {
+    SSL_SESSION_free(it->second);
+    it->second = session;
+  }
+  else
+  {
+    cache.emplace(Peer{std::string(key.host), key.port}, session);
+  }
+
+  log::trace("TLS session cached ({}:{})", host, key.port);
+
+  return 1; // we keep the reference
+}
+
+bool resume_session(SSL *ssl, const char *host, uint16_t port) noexcept
+{
+  SSL_set_ex_data(
+    ssl, port_index(), reinterpret_cast<void *>(std::uintptr_t{port})
+  );
+
+  // (a pooled SSL keeps the session of its last connection, maybe to
+  // another port)
+  SSL_set_session(ssl, nullptr);
+
+  auto &cache = sessions()[SSL_get_SSL_CTX(ssl)];
+
+  auto it = cache.find(PeerView{host, port});
+  if (it == cache.end())
+  {
+    return false;
+  }
+
+  if (expired(it->second) || !SSL_SESSION_is_resumable(it->second))
+  {
+    log::trace("TLS session expired ({}:{})", host, port);
+
+    SSL_SESSION_free(it->second);
+    cache.erase(it);
+    return false;
+  }
+
+  return SSL_set_session(ssl, it->second) == 1;
+}
+
+void forget_session(SSL *ssl, const char *host) noexcept
+{
+  auto &cache = sessions()[SSL_get_SSL_CTX(ssl)];
+
+  if (auto it = cache.find(peer(ssl, host)); it != cache.end())
+  {
+    SSL_SESSION_free(it->second);
+    cache.erase(it);
+  }
+}
+
+void free_sessions() noexcept
+{
+  for (auto &[ctx, cache] : sessions())
+  {
+    for (auto &[peer, session] : cache)
+    {
+      SSL_SESSION_free(session);
+    }
+  }
+
+  sessions().clear();
+}
+
+} // namespace detail
+
+} // namespace manet::transport::tls
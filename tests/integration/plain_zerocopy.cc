@@ -0,0 +1,207 @@
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstddef>
+#include <doctest/doctest.h>
+#include <netinet/in.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <vector>
+
+#include <manet/net/epoll.hpp>
+#include <manet/reactor/io.hpp>
+#include <manet/transport/plain.hpp>
+
+using Net = manet::net::Epoll;
+
+namespace manet::transport::test
+{
+
+/** connected loopback TCP pair (no server needed) */
+struct Loopback
+{
+  int sender = -1;
+  int receiver = -1;
+
+  Loopback()
+  {
+    int listener = ::socket(AF_INET, SOCK_STREAM, 0);
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    socklen_t len = sizeof(addr);
+    REQUIRE(::bind(listener, (sockaddr *)&addr, len) == 0);
+    REQUIRE(::listen(listener, 1) == 0);
+    REQUIRE(::getsockname(listener, (sockaddr *)&addr, &len) == 0);
+
+    receiver = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+    ::connect(receiver, (sockaddr *)&addr, len);
+    sender = ::accept4(listener, nullptr, nullptr, SOCK_NONBLOCK);
+    REQUIRE(sender != -1);
+
+    ::close(listener);
+  }
+
+  ~Loopback()
+  {
+    ::close(sender);
+    ::close(receiver);
+  }
+};
+
+TEST_CASE("plain transport maps received pages (TCP_ZEROCOPY_RECEIVE)")
+{
+  constexpr std::size_t LEN = 1 << 20;
+
+  Loopback tcp;
+
+  // the kernel only has whole pages to hand out if the sender did not copy
+  // them either: send from page-aligned memory with MSG_ZEROCOPY
+  auto *data = static_cast<std::byte *>(::mmap(
+    nullptr, LEN, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0
+  ));
+  REQUIRE(data != MAP_FAILED);
+
+  for (std::size_t i = 0; i < LEN; i++)
+  {
+    data[i] = static_cast<std::byte>(i * 7 % 251);
+  }
+
+  int one = 1;
+  bool zc_send =
+    ::setsockopt(tcp.sender, SOL_SOCKET, SO_ZEROCOPY, &one, sizeof(one)) == 0;
+
+  auto endpoint = Plain::Endpoint<Net>::init(
+    tcp.receiver, PlainConfig{.zerocopy_receive = LEN}
+  );
+  REQUIRE(endpoint.has_value());
+
+  bool zc_receive = endpoint->region != nullptr;
+  if (!zc_receive)
+  {
+    MESSAGE("zero-copy receive is not supported here");
+  }
+
+  static reactor::Buffer<reactor::RX_CAP> rx;
+  rx.clear();
+
+  std::vector<std::byte> received;
+  std::size_t sent = 0;
+  std::size_t mapped = 0;
+
+  for (int spins = 0; received.size() < LEN && spins < 100000; spins++)
+  {
+    if (sent < LEN)
+    {
+      ssize_t n = ::send(
+        tcp.sender, data + sent, std::min<std::size_t>(LEN - sent, 1 << 16),
+        MSG_DONTWAIT | (zc_send ? MSG_ZEROCOPY : 0)
+      );
+      if (n > 0)
+      {
+        sent += n;
+      }
+    }
+
+    std::span<const std::byte> view;
+    auto st = endpoint->read(reactor::RxSink{&rx, nullptr, &view});
+
+    if (!view.empty())
+    {
+      mapped += view.size();
+      received.insert(received.end(), view.begin(), view.end());
+    }
+    else
+    {
+      auto bytes = rx.rbuf();
+      received.insert(received.end(), bytes.begin(), bytes.end());
+      rx.clear();
+    }
+
+    REQUIRE((st == Status::ok || st == Status::want_read));
+  }
+
+  endpoint->destroy();
+  CHECK(endpoint->region == nullptr);
+
+  REQUIRE(received.size() == LEN);
+  CHECK(std::equal(received.begin(), received.end(), data));
+
+  if (zc_receive && zc_send)
+  {
+    CHECK(mapped > 0);
+  }
+
+  ::munmap(data, LEN);
+}
+
+TEST_CASE("plain transport sends TX in place (MSG_ZEROCOPY)")
+{
+  constexpr std::size_t LEN = 1 << 20;
+
+  Loopback tcp;
+
+  auto endpoint = Plain::Endpoint<Net>::init(
+    tcp.sender, PlainConfig{.zerocopy_send = 1 << 14}
+  );
+  REQUIRE(endpoint.has_value());
+
+  bool zc_send = endpoint->zc_threshold > 0;
+  if (!zc_send)
+  {
+    MESSAGE("zero-copy send is not supported here");
+  }
+
+  static reactor::Buffer<reactor::TX_CAP> tx;
+  tx.clear();
+
+  auto data = tx.wbuf().first(LEN);
+  for (std::size_t i = 0; i < LEN; i++)
+  {
+    data[i] = static_cast<std::byte>(i * 7 % 251);
+  }
+  tx.inc_wpos(LEN);
+
+  std::vector<std::byte> received(LEN);
+  std::size_t got = 0;
+  std::size_t max_pinned = 0;
+
+  for (int spins = 0; (got < LEN || tx.pinned() > 0) && spins < 100000;
+       spins++)
+  {
+    if (!tx.rbuf().empty())
+    {
+      auto st = endpoint->write(reactor::Input{&tx});
+      REQUIRE((st == Status::ok || st == Status::want_write));
+    }
+
+    max_pinned = std::max(max_pinned, tx.pinned());
+    endpoint->release(reactor::Input{&tx});
+
+    ssize_t n = ::recv(
+      tcp.receiver, received.data() + got, LEN - got, MSG_DONTWAIT
+    );
+    if (n > 0)
+    {
+      got += n;
+    }
+  }
+
+  REQUIRE(got == LEN);
+  CHECK(std::equal(received.begin(), received.end(), data.begin()));
+
+  // every pinned byte was released, TX is recycled
+  CHECK(tx.pinned() == 0);
+  CHECK(tx.wbuf().size() == reactor::TX_CAP);
+
+  if (zc_send)
+  {
+    CHECK(max_pinned > 0);
+  }
+
+  endpoint->destroy();
+}
+
+} // namespace manet::transport::test
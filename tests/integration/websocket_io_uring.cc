@@ -0,0 +1,75 @@
+#include <doctest/doctest.h>
+#include <ostream>
+#include <pthread.h>
+#include <sstream>
+#include <vector>
+
+#include <manet/net/io_uring.hpp>
+#include <manet/reactor/io.hpp>
+#include <manet/transport/plain.hpp>
+#include <manet/transport/tls.hpp>
+
+#include <manet/protocol/websocket.hpp>
+
+#include "websocket_test.hpp"
+
+using Net = manet::net::IoUring;
+
+namespace manet::protocol::websocket::test::io_uring
+{
+
+/** stop after 1 message (no restart) */
+struct HelloCodec : WsTest
+{
+  Status on_text(reactor::TxSink, std::span<const std::byte> payload) noexcept
+  {
+    write({reinterpret_cast<const char *>(payload.data()), payload.size()});
+    signal_done();
+
+    return Status::error;
+  }
+};
+
+/** stop after LIMIT messages (TEXT) */
+template <std::size_t LIMIT> struct GenCodec : WsTest
+{
+  Status on_text(reactor::TxSink, std::span<const std::byte> payload) noexcept
+  {
+    write({reinterpret_cast<const char *>(payload.data()), payload.size()});
+
+    if (output && LIMIT <= output->size())
+    {
+      signal_done();
+    }
+
+    return Status::ok;
+  }
+};
+
+using Counter = GenCodec<20>;
+
+TEST_CASE("io_uring: websocket client receives [TEXT \"Hello, World!\"]")
+{
+  ConnectionsTest<Net, WsConn<transport::Plain, HelloCodec>> test("/hello");
+  CHECK(test.output<0>() == Trace{"Hello, World!"});
+}
+
+TEST_CASE("io_uring: plain and TLS connections restart on the same ring")
+{
+  ConnectionsTest<
+    Net, WsConn<transport::Plain, Counter>,
+    WsConn<transport::tls::Tls, Counter>>
+    test(std::make_tuple("/counter", "/counter"));
+
+  for (auto const &out : {test.output<0>(), test.output<1>()})
+  {
+    REQUIRE(out.size() == 20);
+
+    for (std::size_t i = 0; i < 20; i++)
+    {
+      CHECK(out[i] == ("counter=" + std::to_string(i % 10)));
+    }
+  }
+}
+
+} // namespace manet::protocol::websocket::test::io_uring
@@ -36,6 +36,24 @@ TEST_CASE("websocket client receives [TEXT \"Hello, World!\"]")
   CHECK(test.output<0>() == Trace{"Hello, World!"});
 }
 
+TEST_CASE("websocket client receives [TEXT \"Hello, World!\"] busy polling")
+{
+  net::EpollConfig busy_poll{
+    .busy_poll_usecs = 50,
+    .socket_busy_poll_usecs = 50,
+    .prefer_busy_poll = true,
+  };
+
+  ConnectionsTest<Net, WsConn<transport::Plain, HelloCodec>> test(
+    "/hello", {}, busy_poll
+  );
+  CHECK(test.output<0>() == Trace{"Hello, World!"});
+
+  // whether the kernel accepted it depends on the kernel and privileges
+  MESSAGE("epoll: ", Net::busy_poll().epoll);
+  MESSAGE("sockets: ", Net::busy_poll().sockets);
+}
+
 struct BinaryCodec : WsTest
 {
   Status on_binary(reactor::TxSink, std::span<const std::byte> payload) noexcept
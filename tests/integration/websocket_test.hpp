@@ -72,8 +72,13 @@ struct MakeWsConnection<Net, WsConn<Transport, Codec>>
 template <typename Net, typename... WsConnections> class ConnectionsTest
 {
 public:
-  ConnectionsTest(auto paths)
-      : _paths(paths)
+  ConnectionsTest(
+    auto paths, transport::tls::TlsConfig tls = {},
+    typename Net::config_t net_config = {}
+  )
+      : _paths(paths),
+        _tls(tls),
+        _net_config(net_config)
   {
     // init all semaphores first (before starting reactor)
     [&]<std::size_t... Is>(std::index_sequence<Is...>)
@@ -114,13 +119,15 @@ private:
   std::tuple<repeat_t<sem_t, WsConnections>...> _dones;
   std::tuple<repeat_t<std::vector<std::string>, WsConnections>...> _outputs;
 
+  transport::tls::TlsConfig _tls;
+  typename Net::config_t _net_config;
+
   std::string host = "localhost";
 
   static void *reactor_worker(void *data)
   {
-    std::monostate net_config{};
     auto *self = static_cast<ConnectionsTest *>(data);
-    self->_reactor.run(net_config, self->make_configs_tuple());
+    self->_reactor.run(self->_net_config, self->make_configs_tuple());
 
     // reactor stopped before posting -> release
     [&]<std::size_t... Is>(std::index_sequence<Is...>)
@@ -159,10 +166,14 @@ private:
 
     if constexpr (std::is_same_v<Transport, transport::tls::Tls>)
     {
+      auto tls = _tls;
+      tls.host = host.c_str();
+      tls.port = 9443;
+
       return config_t{
         .host = host,
         .port = 9443,
-        .transport_config = host.c_str(),
+        .transport_config = tls,
         .protocol_config = config,
       };
     }
@@ -171,7 +182,7 @@ private:
       return config_t{
         .host = host,
         .port = 9000,
-        .transport_config = std::monostate{},
+        .transport_config = {},
         .protocol_config = config,
       };
     }
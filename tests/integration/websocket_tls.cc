@@ -1,7 +1,12 @@
+#include <arpa/inet.h>
+#include <cstdlib>
 #include <doctest/doctest.h>
+#include <netinet/in.h>
 #include <ostream>
 #include <pthread.h>
 #include <sstream>
+#include <sys/socket.h>
+#include <unistd.h>
 #include <vector>
 
 #include <manet/net/epoll.hpp>
@@ -77,6 +82,7 @@ template <std::size_t LIMIT> struct GenCodec : WsTest
 };
 
 using Heartbeat = GenCodec<2>;
+using Counter = GenCodec<20>;
 
 TEST_CASE("stay alive long alive to answer a bunch of PING with PONG")
 {
@@ -90,4 +96,170 @@ TEST_CASE("stay alive long alive to answer a bunch of PING with PONG")
   CHECK(out[1] == "🫀");
 }
 
+TEST_CASE("pinned CA bundle, SPKI pin, groups and ALPN")
+{
+  // test-cert.pem: openssl pkey -pubin -outform der | openssl dgst -sha256
+  transport::tls::TlsConfig tls{
+    .groups = "X25519",
+    .alpn = "http/1.1",
+    .ca_file = std::getenv("SSL_CERT_FILE"),
+    .spki_pin = "kNfmTT42VpkNQPhDlAQQ1Q6K7DVlMBq+NErFE4dPGCk=",
+  };
+
+  ConnectionsTest<Net, WsConn<transport::tls::Tls, HelloCodec>> test(
+    "/hello", tls
+  );
+  CHECK(test.output<0>() == Trace{"Hello, World!"});
+}
+
+TEST_CASE("SPKI pin without chain verification")
+{
+  transport::tls::TlsConfig tls{
+    .spki_pin = "kNfmTT42VpkNQPhDlAQQ1Q6K7DVlMBq+NErFE4dPGCk=",
+  };
+
+  auto before = transport::tls::stats();
+
+  ConnectionsTest<Net, WsConn<transport::tls::Tls, HelloCodec>> test(
+    "/hello", tls
+  );
+  CHECK(test.output<0>() == Trace{"Hello, World!"});
+
+  // the pin was checked: no session of another config was resumed
+  CHECK(transport::tls::stats().resumed == before.resumed);
+  CHECK(before.full < transport::tls::stats().full);
+}
+
+/** a blocking handshake with the test server (sessions kept for `port`) */
+transport::Status
+handshake(transport::tls::TlsConfig tls, uint16_t port = 9443)
+{
+  int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+  REQUIRE(0 <= fd);
+
+  sockaddr_in sa{};
+  sa.sin_family = AF_INET;
+  sa.sin_port = htons(9443);
+  inet_pton(AF_INET, "127.0.0.1", &sa.sin_addr);
+  REQUIRE(::connect(fd, reinterpret_cast<sockaddr *>(&sa), sizeof(sa)) == 0);
+
+  tls.host = "localhost";
+  tls.port = port;
+  auto endpoint = transport::tls::Tls::Endpoint<Net>::init(fd, tls);
+  REQUIRE(endpoint.has_value());
+
+  transport::Status status;
+  do
+  {
+    status = endpoint->handshake_step();
+  } while (status == transport::Status::want_read ||
+           status == transport::Status::want_write);
+
+  endpoint->destroy();
+  ::close(fd);
+
+  return status;
+}
+
+TEST_CASE("a wrong SPKI pin fails the handshake (despite cached sessions)")
+{
+  // a session for localhost under the default config
+  ConnectionsTest<Net, WsConn<transport::tls::Tls, HelloCodec>> test("/hello");
+  CHECK(test.output<0>() == Trace{"Hello, World!"});
+
+  auto before = transport::tls::stats();
+
+  CHECK(
+    handshake({.spki_pin = "AAfmTT42VpkNQPhDlAQQ1Q6K7DVlMBq+NErFE4dPGCk="}) ==
+    transport::Status::error
+  );
+  CHECK(
+    handshake(
+      {.ca_file = std::getenv("SSL_CERT_FILE"),
+       .spki_pin = "AAfmTT42VpkNQPhDlAQQ1Q6K7DVlMBq+NErFE4dPGCk="}
+    ) == transport::Status::error
+  );
+
+  CHECK(transport::tls::stats().resumed == before.resumed);
+
+  // the right pin still connects
+  CHECK(
+    handshake({.spki_pin = "kNfmTT42VpkNQPhDlAQQ1Q6K7DVlMBq+NErFE4dPGCk="}) ==
+    transport::Status::ok
+  );
+}
+
+TEST_CASE("sessions are resumed per host and port")
+{
+  // a session for localhost:9443
+  ConnectionsTest<Net, WsConn<transport::tls::Tls, HelloCodec>> test("/hello");
+  CHECK(test.output<0>() == Trace{"Hello, World!"});
+
+  auto before = transport::tls::stats();
+
+  // (the same server, as far as the cache knows another port)
+  CHECK(handshake({}, 9444) == transport::Status::ok);
+  CHECK(transport::tls::stats().resumed == before.resumed);
+
+  CHECK(handshake({}, 9443) == transport::Status::ok);
+  CHECK(transport::tls::stats().resumed == before.resumed + 1);
+}
+
+TEST_CASE("early data falls back when the server does not allow it")
+{
+  // the test server's tickets allow no early data: regular upgrade
+  ConnectionsTest<Net, WsConn<transport::tls::Tls, HelloCodec>> test(
+    "/hello", {.early_data = true}
+  );
+  CHECK(test.output<0>() == Trace{"Hello, World!"});
+}
+
+TEST_CASE("reconnects resume the TLS session and reuse the SSL object")
+{
+  auto before = transport::tls::stats();
+
+  // /counter closes after 10 messages: the restart resumes the session
+  ConnectionsTest<Net, WsConn<transport::tls::Tls, Counter>> test("/counter");
+  CHECK(test.output<0>().size() == 20);
+
+  auto const &after = transport::tls::stats();
+
+  CHECK(before.resumed + 1 <= after.resumed);
+  CHECK(before.handshake_ns.count() + 2 <= after.handshake_ns.count());
+  CHECK(
+    after.full + after.resumed ==
+    static_cast<uint64_t>(after.handshake_ns.count())
+  );
+
+  // (kTLS endpoints are not pooled)
+  if constexpr (!transport::tls::detail::ktls_enabled)
+  {
+    CHECK(before.ssl_reused + 1 <= after.ssl_reused);
+  }
+}
+
+TEST_CASE("short reads count as drained (one socket read per record)")
+{
+  transport::tls::TlsConfig tls{.short_read_drained = true};
+
+  auto before = transport::tls::stats();
+
+  ConnectionsTest<Net, WsConn<transport::tls::Tls, Counter>> test(
+    "/counter", tls
+  );
+  CHECK(test.output<0>().size() == 20);
+
+  auto const &after = transport::tls::stats();
+
+  auto reads = after.reads - before.reads;
+  auto records = after.records - before.records;
+
+  // (kTLS reads bypass the BIO)
+  if (0 < records)
+  {
+    // one read per record plus the handshakes, each used to need a second
+    CHECK(reads < 2 * records);
+  }
+}
+
 } // namespace manet::protocol::websocket::test
@@ -0,0 +1,231 @@
+#include <chrono>
+#include <doctest/doctest.h>
+#include <variant>
+
+#include "manet/reactor/connection.hpp"
+
+#include "mock/net.hpp"
+#include "mock/protocol.hpp"
+#include "mock/reactor.hpp"
+#include "mock/transport.hpp"
+
+using namespace std::chrono_literals;
+
+namespace deadline_tests
+{
+
+/** established once any data arrived */
+struct UpgradeTest
+{
+  using config_t = std::monostate;
+
+  struct Session
+  {
+    bool upgraded = false;
+
+    Session(std::string_view, uint16_t, config_t) noexcept {}
+
+    bool established() const noexcept { return upgraded; }
+
+    manet::protocol::Status on_data(manet::reactor::IO io) noexcept
+    {
+      io.read(io.rbuf().size());
+      upgraded = true;
+      return manet::protocol::Status::ok;
+    }
+  };
+};
+
+using Conn = TestConnection<UpgradeTest>;
+using Phase = Conn::Phase;
+
+constexpr manet::reactor::Deadlines deadlines{
+  .connect = 100ms, .transport = 200ms, .protocol = 300ms, .close = 400ms
+};
+
+TEST_CASE("Connection::timeout drops the connection when a phase expires")
+{
+  ScriptedTransport::script_t script{};
+  auto t0 = Conn::clock::now();
+
+  SUBCASE("connect")
+  {
+    init_idle_net(true);
+
+    Conn conn("localhost", 101, &script, {}, {.deadlines = deadlines});
+    conn.attach(&conn);
+
+    conn.timeout(t0); // phase clock starts
+    conn.timeout(t0 + 50ms);
+    CHECK(!conn.done());
+
+    conn.timeout(t0 + 150ms);
+    CHECK(conn.closed());
+    CHECK(conn.timed_out() == Phase::connect);
+  }
+
+  SUBCASE("transport handshake")
+  {
+    init_idle_net();
+    script.handshake_results = {manet::transport::Status::want_read};
+
+    Conn conn("localhost", 101, &script, {}, {.deadlines = deadlines});
+    conn.attach(&conn);
+
+    conn.timeout(t0);
+    conn.timeout(t0 + 150ms);
+    CHECK(!conn.done());
+
+    conn.timeout(t0 + 250ms);
+    CHECK(conn.closed());
+    CHECK(conn.timed_out() == Phase::transport);
+  }
+
+  SUBCASE("protocol handshake")
+  {
+    init_idle_net();
+
+    Conn conn("localhost", 101, &script, {}, {.deadlines = deadlines});
+    conn.attach(&conn);
+
+    conn.timeout(t0);
+    conn.timeout(t0 + 350ms);
+    CHECK(conn.closed());
+    CHECK(conn.timed_out() == Phase::protocol);
+  }
+
+  SUBCASE("established connections have no deadline")
+  {
+    init_idle_net();
+    script.read_fragments = {"HTTP/1.1 101"};
+    script.read_status = {
+      manet::transport::Status::ok, manet::transport::Status::want_read
+    };
+
+    Conn conn("localhost", 101, &script, {}, {.deadlines = deadlines});
+    conn.attach(&conn);
+
+    conn.timeout(t0);
+
+    TestNet::event_t ev{.readable = true};
+    conn.handle_event(ev);
+
+    conn.timeout(t0 + 1s);
+    conn.timeout(t0 + 1h);
+    CHECK(!conn.done());
+    CHECK(conn.timed_out() == Phase::none);
+  }
+}
+
+TEST_CASE("a reconnect does not inherit the failed attempt's deadline")
+{
+  ScriptedTransport::script_t script{};
+  auto t0 = Conn::clock::now();
+
+  init_idle_net(true, 2);
+
+  Conn conn("localhost", 101, &script, {}, {.deadlines = deadlines});
+  conn.attach(&conn);
+
+  conn.timeout(t0); // connect clock starts
+
+  // late in its deadline the connect fails, the reconnect (connecting
+  // again) happens in the same tick
+  TestNet::event_t ev{.error = true};
+  conn.handle_event(ev);
+  REQUIRE(conn.done());
+  conn.restart();
+
+  conn.timeout(t0 + 90ms); // (a new clock)
+  conn.timeout(t0 + 150ms);
+  CHECK(!conn.done());
+  CHECK(conn.timed_out() == Phase::none);
+
+  conn.timeout(t0 + 200ms);
+  CHECK(conn.closed());
+  CHECK(conn.timed_out() == Phase::connect);
+}
+
+TEST_CASE("Connection::timeout drops a connection that does not close")
+{
+  ScriptedTransport::script_t script{};
+  auto t0 = Conn::clock::now();
+
+  init_idle_net();
+  script.handshake_results = {manet::transport::Status::want_read};
+  script.shutdown_results = {manet::transport::Status::want_read};
+
+  Conn conn("localhost", 101, &script, {}, {.deadlines = deadlines});
+  conn.attach(&conn);
+
+  conn.timeout(t0);
+  conn.stop();
+  CHECK(!conn.done());
+
+  conn.timeout(t0 + 1ms); // close clock starts
+  conn.timeout(t0 + 350ms);
+  CHECK(!conn.done());
+
+  conn.timeout(t0 + 450ms);
+  CHECK(conn.closed());
+  CHECK(conn.done());
+  CHECK(conn.timed_out() == Phase::close);
+}
+
+/** established once any data arrived, which also stops the reactor */
+struct StopTest : UpgradeTest
+{
+  struct Session : UpgradeTest::Session
+  {
+    using UpgradeTest::Session::Session;
+
+    manet::protocol::Status on_data(manet::reactor::IO io) noexcept
+    {
+      TestNet::signal();
+      return UpgradeTest::Session::on_data(io);
+    }
+  };
+};
+
+TEST_CASE("Reactor stops once a deadline closed the last connection")
+{
+  using StopConn = TestConnection<StopTest>;
+
+  ScriptedTransport::script_t script{};
+  script.read_fragments = {"x"};
+  script.read_status = {
+    manet::transport::Status::ok, manet::transport::Status::want_read
+  };
+  script.shutdown_results = std::deque<manet::transport::Status>(
+    1000, manet::transport::Status::want_read
+  );
+
+  // the peer never closes (no events once the input is read)
+  std::deque<FdAction> actions(2000, FdAction::GrantWrite(0));
+  actions.push_front(FdAction::GrantRead(1));
+
+  std::deque<FdScript> scripts = {FdScript{
+    .actions = std::move(actions),
+    .sentinel = FdScript::sentinel_t::HUP,
+    .input = {reinterpret_cast<const std::byte *>("x"), 1},
+    .connect_async = false,
+  }};
+
+  TestReactor<StopConn> reactor(
+    scripts,
+    std::make_tuple(std::make_tuple(&script, std::monostate{}, deadlines))
+  );
+
+  CHECK(reactor.stopping);
+  CHECK(reactor.all_done());
+  CHECK(!TestNet::_alive); // stopped by the reactor, not by running dry
+
+  auto &conn = *std::get<0>(reactor.connections);
+  CHECK(conn.timed_out() == StopConn::Phase::close);
+
+  // (a round is a simulated millisecond)
+  CHECK(400 < reactor.rounds);
+  CHECK(reactor.rounds < 500);
+}
+
+} // namespace deadline_tests
@@ -0,0 +1,142 @@
+#include <cstring>
+#include <doctest/doctest.h>
+#include <optional>
+#include <span>
+#include <string>
+#include <variant>
+
+#include "manet/reactor/connection.hpp"
+
+#include "mock/net.hpp"
+#include "mock/protocol.hpp"
+
+namespace early_data_tests
+{
+
+using manet::transport::Status;
+
+/** writes everything, early data is possible unless `resumable` is false */
+struct EarlyTransport
+{
+  struct script_t
+  {
+    bool resumable = true;
+    bool accept = true;
+
+    std::string early; // sent as early data
+    std::string output; // sent after the handshake
+  };
+
+  using config_t = script_t *;
+
+  template <typename Net> struct Endpoint
+  {
+    using fd_t = int;
+    script_t *script;
+
+    static std::optional<Endpoint> init(int, config_t script) noexcept
+    {
+      return Endpoint{script};
+    }
+
+    Status handshake_step() noexcept { return Status::ok; }
+
+    bool early_data() const noexcept { return script->resumable; }
+
+    Status
+    early_write(std::span<const std::byte> data, std::size_t &written) noexcept
+    {
+      // one byte at a time: TX must not be consumed in between
+      script->early.push_back(static_cast<char>(data[0]));
+      written = 1;
+      return Status::ok;
+    }
+
+    bool early_accepted() const noexcept { return script->accept; }
+
+    Status read(manet::reactor::RxSink) noexcept { return Status::want_read; }
+
+    Status write(manet::reactor::TxSource out) noexcept
+    {
+      script->output.append(
+        reinterpret_cast<const char *>(out.rbuf().data()), out.rbuf().size()
+      );
+      out.read(out.rbuf().size());
+      return Status::ok;
+    }
+
+    void destroy() noexcept {}
+  };
+};
+
+/** sends a request on connect */
+struct RequestProtocol
+{
+  using config_t = std::monostate;
+
+  static constexpr std::string_view request = "GET / HTTP/1.1\r\n\r\n";
+
+  struct Session
+  {
+    int connects = 0;
+
+    Session(std::string_view, uint16_t, config_t) noexcept {}
+
+    manet::protocol::Status on_connect(manet::reactor::IO io) noexcept
+    {
+      connects++;
+      std::memcpy(io.wbuf().data(), request.data(), request.size());
+      io.wrote(request.size());
+      return manet::protocol::Status::ok;
+    }
+
+    manet::protocol::Status on_data(manet::reactor::IO io) noexcept
+    {
+      io.read(io.rbuf().size());
+      return manet::protocol::Status::ok;
+    }
+  };
+};
+
+using Conn = TestConnection<RequestProtocol, EarlyTransport>;
+
+TEST_CASE("Connection sends on_connect output as early data")
+{
+  init_idle_net();
+
+  EarlyTransport::script_t script{};
+
+  SUBCASE("accepted: nothing is resent")
+  {
+    Conn conn("localhost", 101, &script, {});
+    conn.attach(&conn);
+
+    CHECK(script.early == RequestProtocol::request);
+    CHECK(script.output.empty());
+    CHECK(!conn.done());
+  }
+
+  SUBCASE("rejected: the request is resent after the handshake")
+  {
+    script.accept = false;
+
+    Conn conn("localhost", 101, &script, {});
+    conn.attach(&conn);
+
+    CHECK(script.early == RequestProtocol::request);
+    CHECK(script.output == RequestProtocol::request);
+  }
+
+  SUBCASE("not resumable: regular on_connect after the handshake")
+  {
+    script.resumable = false;
+
+    Conn conn("localhost", 101, &script, {});
+    conn.attach(&conn);
+
+    CHECK(script.early.empty());
+    CHECK(script.output == RequestProtocol::request);
+  }
+}
+
+} // namespace early_data_tests
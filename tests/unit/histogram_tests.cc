@@ -0,0 +1,45 @@
+#include <doctest/doctest.h>
+
+#include <manet/utils/histogram.hpp>
+
+using manet::utils::Histogram;
+
+TEST_CASE("Histogram: log2 buckets and summary")
+{
+  Histogram h;
+
+  CHECK(h.count() == 0);
+  CHECK(h.min() == 0);
+  CHECK(h.quantile(0.5) == 0);
+
+  for (uint64_t v : {0, 1, 2, 3, 4, 1000, 1000, 1000, 1000, 5000})
+  {
+    h.record(v);
+  }
+
+  CHECK(h.count() == 10);
+  CHECK(h.sum() == 9010);
+  CHECK(h.min() == 0);
+  CHECK(h.max() == 5000);
+  CHECK(h.mean() == 901);
+
+  CHECK(h.buckets()[0] == 1);  // 0
+  CHECK(h.buckets()[1] == 1);  // 1
+  CHECK(h.buckets()[2] == 2);  // 2, 3
+  CHECK(h.buckets()[3] == 1);  // 4
+  CHECK(h.buckets()[10] == 4); // 1000
+  CHECK(h.buckets()[13] == 1); // 5000
+
+  // quantiles report the upper bound of their bucket (capped by max)
+  CHECK(h.quantile(0.0) == 0);
+  CHECK(h.quantile(0.5) == 7);
+  CHECK(h.quantile(0.9) == 1023);
+  CHECK(h.quantile(1.0) == 5000);
+
+  h.record(UINT64_MAX);
+  CHECK(h.buckets()[64] == 1);
+  CHECK(h.quantile(1.0) == UINT64_MAX);
+
+  h.clear();
+  CHECK(h.count() == 0);
+}
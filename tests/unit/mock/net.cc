@@ -12,3 +12,15 @@ std::deque<FdAction> gen_script(std::initializer_list<std::string_view> inputs)
 
   return script;
 }
+
+void init_idle_net(bool connect_async, std::size_t sockets)
+{
+  TestNet::init(std::deque<FdScript>(
+    sockets, FdScript{
+               .actions = {},
+               .sentinel = FdScript::sentinel_t::HUP,
+               .input = {},
+               .connect_async = connect_async,
+             }
+  ));
+}
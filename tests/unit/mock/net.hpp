@@ -53,6 +53,9 @@ struct FdScript
   std::span<const std::byte> input;
 
   bool connect_async;
+
+  // returns short reads while more is readable (0: reads take all they can)
+  std::size_t max_read = 0;
 };
 
 struct FdState
@@ -96,6 +99,7 @@ struct TestNet
     bool writeable = false;
 
     bool signal = false;
+    bool wake = false;
     bool close = false;
     bool error = false;
 
@@ -169,13 +173,50 @@ struct TestNet
     }
   }
 
-  static int getsockopt(fd_t, int, int, void *, socklen_t *) noexcept
+  static int bind(fd_t, const void *, socklen_t) noexcept { return 0; }
+
+  // socket options are recorded (in order), getsockopt reads them back
+  struct Sockopt
+  {
+    fd_t fd;
+    int level;
+    int name;
+    std::vector<std::byte> value;
+  };
+
+  static inline std::vector<Sockopt> _sockopts = {};
+
+  static int getsockopt(
+    fd_t fd, int level, int opt_name, void *opt_val, socklen_t *opt_len
+  ) noexcept
+  {
+    for (auto it = _sockopts.rbegin(); it != _sockopts.rend(); ++it)
+    {
+      if (it->fd == fd && it->level == level && it->name == opt_name)
+      {
+        *opt_len = std::min<socklen_t>(*opt_len, it->value.size());
+        std::memcpy(opt_val, it->value.data(), *opt_len);
+        break;
+      }
+    }
+
+    return 0;
+  }
+
+  static int setsockopt(
+    fd_t fd, int level, int opt_name, const void *opt_val, socklen_t opt_len
+  ) noexcept
   {
+    auto *bytes = static_cast<const std::byte *>(opt_val);
+    _sockopts.push_back({fd, level, opt_name, {bytes, bytes + opt_len}});
     return 0;
   }
 
   static void apply() noexcept {}
 
+  // reads that failed with EAGAIN
+  static inline std::size_t _eagain_reads = 0;
+
   static ssize_t read(fd_t fd, void *ptr, std::size_t len) noexcept
   {
     if (!_sockets.contains(fd))
@@ -188,8 +229,14 @@ struct TestNet
 
     auto consumed =
       std::min<std::size_t>({socket.rquota, len, socket.script.input.size()});
+    if (0 < socket.script.max_read)
+    {
+      consumed = std::min(consumed, socket.script.max_read);
+    }
+
     if (consumed == 0)
     {
+      _eagain_reads++;
       errno = EAGAIN;
       return -1;
     }
@@ -237,8 +284,11 @@ struct TestNet
     _scripts = std::move(config);
     _next_fd = 0;
     _signals = 0;
+    _wakes = 0;
     _sockets = {};
     _outputs = {};
+    _sockopts = {};
+    _eagain_reads = 0;
   }
 
   static void run(int (*loop)(void *arg), void *arg)
@@ -251,9 +301,13 @@ struct TestNet
 
   static void signal() noexcept { _signals++; }
 
+  static void wake() noexcept { _wakes++; }
+
   static void stop() noexcept { _alive = false; }
 
-  static int poll(event_t events[], [[maybe_unused]] std::size_t len) noexcept
+  static int poll(
+    event_t events[], [[maybe_unused]] std::size_t len, int /*timeout_ms*/
+  ) noexcept
   {
     assert(len == _sockets.size() + 1); //  avoid fairness issues
 
@@ -264,6 +318,11 @@ struct TestNet
       events[i++] = {.signal = true};
       _signals--;
     }
+    else if (_wakes)
+    {
+      events[i++] = {.wake = true};
+      _wakes = 0; // one event for any number of wakes
+    }
 
     for (auto it = _sockets.begin(); it != _sockets.end();)
     {
@@ -359,6 +418,8 @@ struct TestNet
   // events
   static bool ev_signal(const event_t &ev) noexcept { return ev.signal; }
 
+  static bool ev_wake(const event_t &ev) noexcept { return ev.wake; }
+
   static bool ev_close(const event_t &ev) noexcept { return ev.close; }
 
   static bool ev_error(const event_t &ev) noexcept { return ev.error; }
@@ -417,12 +478,16 @@ private:
   static inline config_t _scripts;
   static inline fd_t _next_fd = 0;
   static inline std::size_t _signals = 0;
+  static inline std::size_t _wakes = 0;
   static inline std::unordered_map<fd_t, FdState> _sockets = {};
   static inline std::unordered_map<fd_t, std::vector<std::byte>> _outputs = {};
 };
 
 std::deque<FdAction> gen_script(std::initializer_list<std::string_view> inputs);
 
+/** `sockets` connections without script: no events until they hang up */
+void init_idle_net(bool connect_async = false, std::size_t sockets = 1);
+
 /*static std::string to_string(std::deque<FdAction> script)
 {
   std::string str;
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <variant>
+
+#include "manet/protocol/status.hpp"
+#include "manet/reactor/connection.hpp"
+#include "manet/reactor/io.hpp"
+
+#include "net.hpp"
+#include "transport.hpp"
+
+/** Connection over the mock net (scripted transport by default) */
+template <typename Protocol, typename Transport = ScriptedTransport>
+using TestConnection = manet::reactor::Connection<TestNet, Transport, Protocol>;
+
+/** records whatever arrives */
+struct RecordTest
+{
+  using config_t = std::monostate;
+
+  static inline std::string received;
+
+  struct Session
+  {
+    Session(std::string_view, uint16_t, config_t) noexcept {}
+
+    manet::protocol::Status on_data(manet::reactor::IO io) noexcept
+    {
+      auto bytes = io.rbuf();
+      received.append(
+        reinterpret_cast<const char *>(bytes.data()), bytes.size()
+      );
+      io.read(bytes.size());
+      return manet::protocol::Status::ok;
+    }
+  };
+};
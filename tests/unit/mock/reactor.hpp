@@ -1,8 +1,11 @@
 #pragma once
 #include <doctest/doctest.h>
 
+#include <chrono>
 #include <utility>
 
+#include "manet/reactor/ready.hpp"
+
 #include "net.hpp"
 #include "transport.hpp"
 
@@ -16,12 +19,19 @@ public:
 
   std::tuple<std::optional<Connections>...> connections{};
   std::array<event_t, NUM_EVENTS> events{};
+  manet::reactor::ReadyList<TestNet, NUM_CONNECTIONS> ready{};
 
-  static inline uint64_t counter = 0;
   bool stopping = false;
 
+  // simulated time for the deadlines and heartbeats: every round takes a
+  // millisecond
+  static constexpr std::chrono::milliseconds heartbeat_interval{128};
+  std::chrono::steady_clock::time_point now{};
+  std::chrono::steady_clock::time_point next_heartbeat{heartbeat_interval};
+
   // test outputs
   std::vector<int> restarts = {};
+  uint64_t rounds = 0;
 
   template <typename... Configs>
   TestReactor(TestNet::config_t &config, const std::tuple<Configs...> &cfgs)
@@ -74,10 +84,18 @@ private:
     std::string host = "localhost";
     uint16_t port = 101;
 
+    // (optional) deadlines
+    manet::reactor::Deadlines deadlines{};
+    if constexpr (2 < std::tuple_size_v<Config>)
+    {
+      deadlines = std::get<2>(cfg);
+    }
+
     auto &opt = std::get<I>(connections);
     opt.emplace(
       std::move(host), port, std::move(std::get<0>(cfg)),
-      std::move(std::get<1>(cfg))
+      std::move(std::get<1>(cfg)),
+      manet::reactor::ConnectionOptions{.deadlines = deadlines}
     );
 
     Conn *conn = std::addressof(*opt);
@@ -90,7 +108,7 @@ private:
   {
     auto *self = static_cast<TestReactor *>(data);
 
-    int nevents = TestNet::poll(self->events.data(), NUM_EVENTS);
+    int nevents = TestNet::poll(self->events.data(), NUM_EVENTS, 0);
     if (nevents < 0)
     {
       manet::log::error("poll failed");
@@ -110,6 +128,10 @@ private:
           self->stop_all();
         }
       }
+      else if (TestNet::ev_wake(ev))
+      {
+        self->wake_all();
+      }
       else
       {
         void *ptr = TestNet::get_user_data(ev);
@@ -124,31 +146,105 @@ private:
             // conn->restart();
             self->restarts.push_back(self->_conn_id(conn));
           }
+
+          self->ready.push(conn);
         }
       }
+    }
 
-      if (self->stopping && self->all_done())
+    self->ready.resume(
+      [self](manet::reactor::BaseConnection<TestNet> *conn)
       {
-        TestNet::stop();
+        if (!self->stopping && conn->closed())
+        {
+          self->restarts.push_back(self->_conn_id(conn));
+        }
       }
-    }
+    );
 
-    if ((++counter & 127) == 0)
+    self->rounds++;
+    self->now += std::chrono::milliseconds{1};
+    self->timeouts(self->now);
+
+    if (self->next_heartbeat <= self->now)
     {
+      self->next_heartbeat = self->now + heartbeat_interval;
       self->heartbeat();
     }
 
+    if (self->stopping && self->all_done())
+    {
+      TestNet::stop();
+    }
+
     return 0;
   }
 
+  void timeouts(std::chrono::steady_clock::time_point now) noexcept
+  {
+    std::apply(
+      [this, now](auto &...opt) { ((opt ? timeout(*opt, now) : void()), ...); },
+      connections
+    );
+  }
+
+  template <typename Conn>
+  void timeout(Conn &conn, std::chrono::steady_clock::time_point now) noexcept
+  {
+    bool closed = conn.closed();
+    conn.settle();
+    conn.timeout(now);
+
+    // (not restarted here: only count the connections a deadline dropped)
+    if (!stopping && !closed && conn.closed())
+    {
+      restarts.push_back(_conn_id(&conn));
+    }
+  }
+
   void heartbeat() noexcept
   {
     std::apply(
-      [](auto &...opt) { ((opt ? opt->heartbeat() : void()), ...); },
+      [this](auto &...opt) { ((opt ? heartbeat(*opt) : void()), ...); },
       connections
     );
   }
 
+  template <typename Conn> void heartbeat(Conn &conn) noexcept
+  {
+    conn.heartbeat();
+
+    if (!stopping && conn.closed())
+    {
+      // conn.restart();
+      restarts.push_back(_conn_id(&conn));
+    }
+  }
+
+  void wake_all() noexcept
+  {
+    std::apply(
+      [this](auto &...opt) { ((opt ? wake(*opt) : void()), ...); }, connections
+    );
+  }
+
+  template <typename Conn> void wake(Conn &conn) noexcept
+  {
+    if (!conn.paused())
+    {
+      return;
+    }
+
+    conn.wake();
+
+    if (!stopping && conn.closed())
+    {
+      restarts.push_back(_conn_id(&conn));
+    }
+
+    ready.push(&conn);
+  }
+
   void stop_all() noexcept
   {
     std::apply(
@@ -160,7 +256,7 @@ private:
 struct ReactorOutputs
 {
   std::vector<int> restarts;
-  uint64_t counter;
+  uint64_t rounds;
   bool all_done;
 };
 
@@ -211,5 +307,5 @@ ReactorOutputs test1(
   );
 
   // return a couple of extra outputs to validate:
-  return {reactor.restarts, reactor.counter, reactor.all_done()};
+  return {reactor.restarts, reactor.rounds, reactor.all_done()};
 }
@@ -21,6 +21,7 @@ struct ScriptedTransport
 
     // write script
     std::deque<manet::transport::Status> write_status;
+    std::size_t writes = 0; // write calls
 
     // what the FSM wrote (share access such that we can retrieve output easily)
     std::shared_ptr<std::string> output = std::make_shared<std::string>();
@@ -88,6 +89,8 @@ struct ScriptedTransport
 
     manet::transport::Status write(manet::reactor::TxSource out) noexcept
     {
+      script->writes++;
+
       if (script->write_status.empty())
       {
         // by default, accept and record everything
@@ -0,0 +1,200 @@
+#include <cstddef>
+#include <deque>
+#include <doctest/doctest.h>
+#include <string>
+#include <string_view>
+#include <variant>
+
+#include "manet/reactor/connection.hpp"
+#include "manet/transport/plain.hpp"
+
+#include "mock/protocol.hpp"
+#include "mock/reactor.hpp"
+
+namespace pause_tests
+{
+
+/** records whatever arrives, pauses while the gate is closed */
+struct GateTest
+{
+  using config_t = std::monostate;
+
+  static inline std::string received;
+  static inline bool open = true;
+
+  // pause the first delivery and ask to be woken
+  static inline bool pause_once = false;
+
+  struct Session
+  {
+    Session(std::string_view, uint16_t, config_t) noexcept {}
+
+    manet::protocol::Status on_data(manet::reactor::IO io) noexcept
+    {
+      if (pause_once)
+      {
+        pause_once = false;
+        TestNet::wake();
+        return manet::protocol::Status::pause;
+      }
+
+      if (!open)
+      {
+        return manet::protocol::Status::pause;
+      }
+
+      auto bytes = io.rbuf();
+      received.append(
+        reinterpret_cast<const char *>(bytes.data()), bytes.size()
+      );
+      io.read(bytes.size());
+      return manet::protocol::Status::ok;
+    }
+  };
+};
+
+/** a gate that is dropped by its heartbeat once nothing arrived for
+ * `stale_after` ticks */
+struct StaleGateTest : GateTest
+{
+  static inline int tick = 0;
+  static constexpr int stale_after = 2;
+
+  struct Session : GateTest::Session
+  {
+    using GateTest::Session::Session;
+
+    int last_rx = 0;
+    int resumes = 0;
+
+    manet::protocol::Status on_data(manet::reactor::IO io) noexcept
+    {
+      last_rx = tick;
+      return GateTest::Session::on_data(io);
+    }
+
+    manet::protocol::Status heartbeat(manet::reactor::TxSink) noexcept
+    {
+      return stale_after < tick - last_rx ? manet::protocol::Status::close
+                                          : manet::protocol::Status::ok;
+    }
+
+    void on_resume() noexcept
+    {
+      last_rx = tick;
+      resumes++;
+    }
+  };
+};
+
+void init(bool open, bool pause_once)
+{
+  GateTest::received.clear();
+  GateTest::open = open;
+  GateTest::pause_once = pause_once;
+}
+
+TEST_CASE("a paused connection stops reading until woken")
+{
+  using Conn = TestConnection<GateTest>;
+
+  init_idle_net();
+  init(false, false);
+
+  ScriptedTransport::script_t script = happypath({"ab", "cd"});
+  script.read_status.back() = manet::transport::Status::want_read;
+
+  Conn conn("localhost", 101, &script, {});
+  conn.attach(&conn);
+
+  TestNet::event_t ev{.readable = true};
+  conn.handle_event(ev);
+
+  CHECK(conn.paused());
+  CHECK(GateTest::received.empty());
+  CHECK(script.read_status.size() == 2); // "cd" is left in the socket
+
+  // readable edges are ignored while paused
+  conn.handle_event(ev);
+  CHECK(script.read_status.size() == 2);
+  CHECK(!conn.backlogged());
+
+  // still paused: nothing changes
+  conn.wake();
+  CHECK(conn.paused());
+  CHECK(GateTest::received.empty());
+
+  GateTest::open = true;
+  conn.wake();
+
+  CHECK(!conn.paused());
+  CHECK(!conn.closed());
+  CHECK(GateTest::received == "abcd");
+  CHECK(conn.paused_ns().count() == 1);
+}
+
+TEST_CASE("a paused connection is not dropped by its heartbeat")
+{
+  using Conn = TestConnection<StaleGateTest>;
+
+  init_idle_net();
+  init(false, false);
+  StaleGateTest::tick = 0;
+
+  ScriptedTransport::script_t script = happypath({"ab", "cd"});
+  script.read_status.back() = manet::transport::Status::want_read;
+
+  Conn conn("localhost", 101, &script, {});
+  conn.attach(&conn);
+
+  TestNet::event_t ev{.readable = true};
+  conn.handle_event(ev);
+  REQUIRE(conn.paused());
+
+  // well past the deadline: reading was held back, not starved by the peer
+  StaleGateTest::tick = 10;
+  conn.heartbeat();
+  CHECK(!conn.closed());
+
+  GateTest::open = true;
+  conn.wake();
+  REQUIRE(!conn.paused());
+  CHECK(GateTest::received == "abcd");
+
+  // resumed: the clock starts over
+  StaleGateTest::tick = 12;
+  conn.heartbeat();
+  CHECK(!conn.closed());
+
+  StaleGateTest::tick = 13;
+  conn.heartbeat();
+  CHECK(conn.closed());
+}
+
+TEST_CASE("Net::wake resumes paused connections")
+{
+  using Conn = TestConnection<GateTest, manet::transport::Plain>;
+
+  auto R = FdAction::GrantRead;
+  std::string_view input = "hello, world";
+
+  std::deque<FdScript> scripts = {FdScript{
+    .actions = {R(5), R(7), R(0), R(0)},
+    .sentinel = FdScript::sentinel_t::HUP,
+    .input = {reinterpret_cast<const std::byte *>(input.data()), input.size()},
+    .connect_async = false,
+  }};
+  init(true, true);
+
+  TestReactor<Conn> reactor(
+    scripts, std::make_tuple(std::make_tuple(
+               manet::transport::PlainConfig{}, std::monostate{}
+             ))
+  );
+
+  CHECK(reactor.restarts.empty());
+  CHECK(GateTest::open);
+  CHECK(GateTest::received == input);
+}
+
+} // namespace pause_tests
@@ -0,0 +1,158 @@
+#include <doctest/doctest.h>
+#include <string>
+#include <variant>
+#include <vector>
+
+#include "manet/reactor/connection.hpp"
+#include "manet/reactor/ready.hpp"
+
+#include "mock/net.hpp"
+#include "mock/protocol.hpp"
+#include "mock/transport.hpp"
+
+namespace scheduling_tests
+{
+
+using Conn = TestConnection<RecordTest>;
+
+void init()
+{
+  init_idle_net();
+  RecordTest::received.clear();
+}
+
+ScriptedTransport::script_t chunks()
+{
+  ScriptedTransport::script_t script = happypath({"ab", "cd", "ef"});
+  script.read_status.back() = manet::transport::Status::want_read;
+  return script;
+}
+
+TEST_CASE("read budget splits a readable event")
+{
+  init();
+
+  auto script = chunks();
+
+  Conn conn(
+    "localhost", 101, &script, {}, {.scheduling = {.read_budget = 2}}
+  );
+  conn.attach(&conn);
+
+  TestNet::event_t ev{.readable = true};
+  conn.handle_event(ev);
+
+  CHECK(RecordTest::received == "ab");
+  CHECK(conn.backlogged());
+
+  conn.resume();
+  CHECK(RecordTest::received == "abcd");
+  CHECK(conn.backlogged());
+
+  conn.resume();
+  CHECK(RecordTest::received == "abcdef");
+  CHECK(conn.backlogged());
+
+  // the transport runs dry: back to waiting for the next edge
+  conn.resume();
+  CHECK(RecordTest::received == "abcdef");
+  CHECK(!conn.backlogged());
+  CHECK(!conn.closed());
+}
+
+TEST_CASE("weight multiplies the read budget")
+{
+  init();
+
+  auto script = chunks();
+
+  Conn conn(
+    "localhost", 101, &script, {},
+    {.scheduling = {.read_budget = 2, .weight = 2}}
+  );
+  conn.attach(&conn);
+
+  TestNet::event_t ev{.readable = true};
+  conn.handle_event(ev);
+
+  CHECK(RecordTest::received == "abcd");
+  CHECK(conn.backlogged());
+}
+
+TEST_CASE("without a budget an event reads until the transport runs dry")
+{
+  init();
+
+  auto script = chunks();
+
+  Conn conn("localhost", 101, &script, {});
+  conn.attach(&conn);
+
+  TestNet::event_t ev{.readable = true};
+  conn.handle_event(ev);
+
+  CHECK(RecordTest::received == "abcdef");
+  CHECK(!conn.backlogged());
+}
+
+/** backlogged for `rounds` resumes */
+struct FakeConn : manet::reactor::BaseConnection<TestNet>
+{
+  int id;
+  unsigned w;
+  int rounds;
+  std::vector<int> *order;
+
+  FakeConn(int id, unsigned w, int rounds, std::vector<int> *order)
+      : id(id), w(w), rounds(rounds), order(order)
+  {
+  }
+
+  void handle_event(TestNet::event_t &) noexcept override {}
+  void restart() noexcept override {}
+  bool closed() const noexcept override { return false; }
+  bool done() const noexcept override { return false; }
+
+  bool backlogged() const noexcept override { return rounds > 0; }
+  unsigned weight() const noexcept override { return w; }
+
+  void resume() noexcept override
+  {
+    order->push_back(id);
+    rounds--;
+  }
+};
+
+TEST_CASE("ready list resumes heavier connections first")
+{
+  std::vector<int> order;
+
+  FakeConn bulk1(1, 1, 2, &order);
+  FakeConn bulk2(2, 1, 1, &order);
+  FakeConn quotes(3, 4, 1, &order);
+  FakeConn idle(4, 8, 0, &order);
+
+  manet::reactor::ReadyList<TestNet, 4> ready;
+  ready.push(&bulk1);
+  ready.push(&bulk2);
+  ready.push(&quotes);
+  ready.push(&idle);  // not backlogged
+  ready.push(&bulk1); // already queued
+
+  CHECK(ready.size() == 3);
+
+  int resumed = 0;
+  ready.resume([&](auto *) { resumed++; });
+
+  CHECK(order == std::vector<int>{3, 1, 2});
+  CHECK(resumed == 3);
+
+  // bulk1 still has data: next round
+  CHECK(ready.size() == 1);
+
+  ready.resume([](auto *) {});
+  CHECK(order == std::vector<int>{3, 1, 2, 1});
+  CHECK(ready.empty());
+}
+
+} // namespace scheduling_tests
@@ -0,0 +1,96 @@
+#include <cstddef>
+#include <deque>
+#include <doctest/doctest.h>
+#include <random>
+#include <string>
+#include <string_view>
+
+#include "manet/transport/plain.hpp"
+
+#include "mock/protocol.hpp"
+#include "mock/reactor.hpp"
+
+namespace short_read_tests
+{
+
+using Conn = TestConnection<RecordTest, manet::transport::Plain>;
+
+auto R = FdAction::GrantRead;
+
+/** feed `input` as scripted, returns the reads that failed with EAGAIN */
+std::size_t run(
+  std::string_view input, std::deque<FdAction> actions, std::size_t max_read,
+  bool short_read_drained
+)
+{
+  std::deque<FdScript> scripts = {FdScript{
+    .actions = std::move(actions),
+    .sentinel = FdScript::sentinel_t::HUP,
+    .input = {reinterpret_cast<const std::byte *>(input.data()), input.size()},
+    .connect_async = false,
+    .max_read = max_read,
+  }};
+
+  RecordTest::received.clear();
+
+  TestReactor<Conn> reactor(
+    scripts, std::make_tuple(std::make_tuple(
+               manet::transport::PlainConfig{
+                 .short_read_drained = short_read_drained
+               },
+               std::monostate{}
+             ))
+  );
+
+  CHECK(reactor.restarts.empty());
+  CHECK(RecordTest::received == input);
+
+  return TestNet::_eagain_reads;
+}
+
+TEST_CASE("short reads count as drained without missing data")
+{
+  std::mt19937 rng(42);
+
+  auto uniform = [&](std::size_t lo, std::size_t hi)
+  { return std::uniform_int_distribution<std::size_t>(lo, hi)(rng); };
+
+  std::size_t eagain = 0;
+  std::size_t eagain_elided = 0;
+
+  for (int round = 0; round < 500; round++)
+  {
+    std::string input(uniform(1, 200), '\0');
+    for (char &c : input)
+    {
+      c = static_cast<char>('a' + uniform(0, 25));
+    }
+
+    // arrivals of random size (and pauses) ...
+    std::deque<FdAction> actions;
+    for (std::size_t granted = 0; granted < input.size();)
+    {
+      auto quota = uniform(0, 16);
+      actions.push_back(R(quota));
+      granted += quota;
+    }
+
+    // ... then enough quiet polls to read the rest one byte at a time
+    for (std::size_t i = 0; i <= input.size(); i++)
+    {
+      actions.push_back(R(0));
+    }
+
+    // reads may also come back short while more is readable
+    std::size_t max_read = uniform(0, 1) ? uniform(1, 8) : 0;
+
+    eagain += run(input, actions, max_read, false);
+    eagain_elided += run(input, actions, max_read, true);
+  }
+
+  // every edge used to end in a failing read
+  CHECK(eagain >= 500);
+  CHECK(eagain_elided == 0);
+}
+
+} // namespace short_read_tests
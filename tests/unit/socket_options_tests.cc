@@ -0,0 +1,100 @@
+#include <algorithm>
+#include <doctest/doctest.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <variant>
+
+#include "manet/reactor/connection.hpp"
+
+#include "mock/net.hpp"
+#include "mock/protocol.hpp"
+#include "mock/transport.hpp"
+
+namespace socket_options_tests
+{
+
+/** consumes whatever arrives */
+struct DrainTest
+{
+  using config_t = std::monostate;
+
+  struct Session
+  {
+    Session(std::string_view, uint16_t, config_t) noexcept {}
+
+    manet::protocol::Status on_data(manet::reactor::IO io) noexcept
+    {
+      io.read(io.rbuf().size());
+      return manet::protocol::Status::ok;
+    }
+  };
+};
+
+using Conn = TestConnection<DrainTest>;
+
+std::size_t count(int level, int name)
+{
+  return std::ranges::count_if(
+    TestNet::_sockopts,
+    [&](const auto &opt) { return opt.level == level && opt.name == name; }
+  );
+}
+
+int value(int level, int name)
+{
+  int v = -1;
+  socklen_t len = sizeof(v);
+  TestNet::getsockopt(0, level, name, &v, &len);
+  return v;
+}
+
+TEST_CASE("dial applies the socket options")
+{
+  init_idle_net();
+
+  ScriptedTransport::script_t script = happypath({"a"});
+
+  Conn conn(
+    "localhost", 101, &script, {},
+    {.socket_options = {
+       .rcvbuf = 1 << 20,
+       .priority = 6,
+       .tos = 0x10,
+       .user_timeout_ms = 5000,
+     }}
+  );
+  conn.attach(&conn);
+
+  CHECK(value(IPPROTO_TCP, TCP_NODELAY) == 1); // on by default
+  CHECK(value(SOL_SOCKET, SO_RCVBUF) == 1 << 20);
+  CHECK(value(SOL_SOCKET, SO_PRIORITY) == 6);
+  CHECK(value(IPPROTO_IP, IP_TOS) == 0x10);
+  CHECK(value(IPPROTO_TCP, TCP_USER_TIMEOUT) == 5000);
+
+  // unset options keep the kernel defaults
+  CHECK(count(SOL_SOCKET, SO_SNDBUF) == 0);
+  CHECK(count(IPPROTO_TCP, TCP_QUICKACK) == 0);
+}
+
+TEST_CASE("quickack is re-armed after reads")
+{
+  init_idle_net();
+
+  ScriptedTransport::script_t script = happypath({"a", "b"});
+  script.read_status.back() = manet::transport::Status::want_read;
+
+  Conn conn(
+    "localhost", 101, &script, {}, {.socket_options = {.quickack = true}}
+  );
+  conn.attach(&conn);
+
+  auto before = count(IPPROTO_TCP, TCP_QUICKACK);
+  CHECK(before == 1); // set by dial
+
+  TestNet::event_t ev{.readable = true};
+  conn.handle_event(ev);
+
+  CHECK(count(IPPROTO_TCP, TCP_QUICKACK) == before + 1);
+}
+
+} // namespace socket_options_tests
@@ -1,7 +1,10 @@
 #include <cstdint>
+#include <cstring>
+#include <string>
 #include <string_view>
 #include <tuple>
 #include <variant>
+#include <vector>
 
 #include "manet/reactor/io.hpp"
 #include "manet/transport/plain.hpp"
@@ -345,11 +348,171 @@ struct DrainCloseTransport
   };
 };
 
+/** hands out received chunks in place when offered (otw. copies them) */
+struct MappedTransport
+{
+  struct script_t
+  {
+    std::vector<std::string> chunks;
+    std::size_t next = 0;
+    std::string output = "";
+  };
+
+  using config_t = script_t *;
+
+  template <typename Net> struct Endpoint
+  {
+    script_t *script;
+    std::size_t pinned = 0; // (of this endpoint)
+
+    static std::optional<Endpoint>
+    init(typename Net::fd_t, config_t script) noexcept
+    {
+      return Endpoint{script};
+    }
+
+    Status read(reactor::RxSink in) noexcept
+    {
+      if (script->next == script->chunks.size())
+        return Status::want_read;
+
+      auto &chunk = script->chunks[script->next++];
+      auto bytes = std::as_bytes(std::span(chunk));
+
+      if (in.mapped)
+      {
+        *in.mapped = bytes;
+      }
+      else
+      {
+        std::memcpy(in.wbuf().data(), bytes.data(), bytes.size());
+        in.wrote(bytes.size());
+      }
+
+      return Status::ok;
+    }
+
+    Status write(reactor::TxSource out) noexcept
+    {
+      auto buf = out.rbuf();
+      script->output.append(
+        reinterpret_cast<const char *>(buf.data()), buf.size()
+      );
+      out.read(buf.size());
+      return Status::ok;
+    }
+
+    void destroy() noexcept {}
+  };
+};
+
+/** every write stays pinned until the test lets `release` unpin it */
+struct PinningTransport
+{
+  struct script_t
+  {
+    std::vector<std::string> chunks;
+    std::size_t next = 0;
+    std::size_t readable = 0; // chunks to hand out
+    bool released = false;    // the "kernel" is done with pinned bytes
+    std::size_t pinned = 0;
+    std::size_t destroyed = 0; // endpoints whose socket was closed
+    std::vector<const std::byte *> writes = {};
+  };
+
+  using config_t = script_t *;
+
+  template <typename Net> struct Endpoint
+  {
+    script_t *script;
+    std::size_t pinned = 0; // (of this endpoint)
+
+    static std::optional<Endpoint>
+    init(typename Net::fd_t, config_t script) noexcept
+    {
+      return Endpoint{script};
+    }
+
+    Status read(reactor::RxSink in) noexcept
+    {
+      if (script->readable == 0)
+        return Status::want_read;
+
+      script->readable--;
+
+      auto &chunk = script->chunks[script->next++];
+      std::memcpy(in.wbuf().data(), chunk.data(), chunk.size());
+      in.wrote(chunk.size());
+
+      return Status::ok;
+    }
+
+    Status write(reactor::TxSource out) noexcept
+    {
+      auto buf = out.rbuf();
+      script->writes.push_back(buf.data());
+      script->pinned += buf.size();
+      pinned += buf.size();
+
+      out.pin(buf.size());
+      out.read(buf.size());
+      return Status::ok;
+    }
+
+    void release(reactor::TxSource out) noexcept
+    {
+      if (script->released)
+      {
+        out.unpin(pinned);
+        script->pinned -= pinned;
+        pinned = 0;
+      }
+    }
+
+    bool settled() const noexcept { return pinned == 0; }
+
+    void destroy() noexcept { script->destroyed++; }
+  };
+};
+
 } // namespace transport
 
 namespace protocol
 {
 
+/** echoes two bytes at a time, remembers where it read them from */
+struct PairProtocol
+{
+  using config_t = std::vector<const std::byte *> *;
+
+  struct Session
+  {
+    config_t reads;
+
+    Session(std::string_view, uint16_t, config_t reads) noexcept
+        : reads(reads)
+    {
+    }
+
+    Status on_data(reactor::IO io) noexcept
+    {
+      auto in = io.rbuf();
+      auto out = io.wbuf();
+
+      if (in.size() < 2)
+        return Status::ok; // need more
+
+      reads->push_back(in.data());
+
+      std::memcpy(out.data(), in.data(), 2);
+      io.read(2);
+      io.wrote(2);
+
+      return Status::ok;
+    }
+  };
+};
+
 struct ReflectProtocol
 {
   using config_t = std::monostate;
@@ -1198,4 +1361,138 @@ TEST_CASE(
   CHECK(outputs.restarts[0] == 0); // Closed
 }
 
+TEST_CASE("<ScriptedTransport,ReflectProtocol> corking writes once per event")
+{
+  using Conn =
+    reactor::Connection<TestNet, ScriptedTransport, protocol::ReflectProtocol>;
+
+  for (bool cork : {false, true})
+  {
+    init_idle_net();
+
+    // three frames arrive with one readable edge
+    ScriptedTransport::script_t script = happypath({"a", "b", "c"});
+    script.read_status.back() = transport::Status::want_read;
+
+    Conn conn("localhost", 101, &script, {}, {.cork = cork});
+    conn.attach(&conn);
+
+    auto before = script.writes;
+
+    TestNet::event_t ev{.readable = true};
+    conn.handle_event(ev);
+
+    CHECK(*script.output == "abc");
+    CHECK(script.writes - before == (cork ? 1 : 3));
+  }
+}
+
+TEST_CASE("<MappedTransport,PairProtocol> protocol reads mapped bytes in place")
+{
+  using Conn = reactor::
+    Connection<TestNet, transport::MappedTransport, protocol::PairProtocol>;
+
+  init_idle_net();
+
+  // "e" is left over and kept in RX, "f" is then copied after it
+  transport::MappedTransport::script_t script{
+    .chunks = {"abcde", "f", "gh"}
+  };
+  std::vector<const std::byte *> reads;
+
+  Conn conn("localhost", 101, &script, &reads);
+  conn.attach(&conn);
+
+  TestNet::event_t ev{.readable = true};
+  conn.handle_event(ev);
+
+  CHECK(script.output == "abcdefgh");
+
+  auto chunk = [&](std::size_t i, std::size_t pos)
+  { return std::as_bytes(std::span(script.chunks[i])).data() + pos; };
+
+  REQUIRE(reads.size() == 4);
+  CHECK(reads[0] == chunk(0, 0));
+  CHECK(reads[1] == chunk(0, 2));
+  CHECK(reads[2] != chunk(0, 4)); // "ef" from RX
+  CHECK(reads[3] == chunk(2, 0));
+}
+
+TEST_CASE("<PinningTransport,ReflectProtocol> pinned TX is not recycled")
+{
+  using Conn = reactor::
+    Connection<TestNet, transport::PinningTransport, protocol::ReflectProtocol>;
+
+  init_idle_net();
+
+  transport::PinningTransport::script_t script{.chunks = {"ab", "cd", "ef"}};
+
+  Conn conn("localhost", 101, &script, {});
+  conn.attach(&conn);
+
+  TestNet::event_t ev{.readable = true};
+
+  script.readable = 1;
+  conn.handle_event(ev);
+
+  // "ab" is sent but pinned: "cd" must not overwrite it
+  script.readable = 1;
+  conn.handle_event(ev);
+
+  REQUIRE(script.writes.size() == 2);
+  CHECK(script.writes[1] == script.writes[0] + 2);
+
+  // once released TX starts over
+  script.released = true;
+  script.readable = 1;
+  conn.handle_event(ev);
+
+  REQUIRE(script.writes.size() == 3);
+  CHECK(script.writes[2] == script.writes[0]);
+  CHECK(script.pinned == 2);
+}
+
+TEST_CASE("<PinningTransport,ReflectProtocol> pinned TX is parked on reconnect")
+{
+  using Conn = reactor::
+    Connection<TestNet, transport::PinningTransport, protocol::ReflectProtocol>;
+
+  init_idle_net(false, 2); // (reconnects)
+
+  transport::PinningTransport::script_t script{.chunks = {"ab", "cd"}};
+
+  Conn conn("localhost", 101, &script, {});
+  conn.attach(&conn);
+
+  TestNet::event_t ev{.readable = true};
+
+  script.readable = 1;
+  conn.handle_event(ev);
+  REQUIRE(script.pinned == 2);
+
+  conn.stop();
+  REQUIRE(conn.done());
+
+  // the kernel may still send "ab": its socket stays open
+  conn.restart();
+  CHECK(script.destroyed == 0);
+  CHECK(script.pinned == 2);
+
+  // (nor is "ab" overwritten)
+  script.readable = 1;
+  conn.handle_event(ev);
+
+  REQUIRE(script.writes.size() == 2);
+  CHECK(script.writes[1] == script.writes[0] + 2);
+
+  conn.settle();
+  CHECK(script.destroyed == 0);
+
+  // released: the next round closes it ("cd" stays pinned)
+  script.released = true;
+  conn.settle();
+  CHECK(script.destroyed == 1);
+  CHECK(script.pinned == 2);
+}
+
 } // namespace manet::transport_tests
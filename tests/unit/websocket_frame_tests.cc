@@ -218,3 +218,28 @@ TEST_CASE("parse_frame: need_more for partial header and payload")
     CHECK(status == detail::parse_status::need_more);
   }
 }
+
+TEST_CASE("parse_header: header of a frame whose payload is still in flight")
+{
+  // FIN=0, binary, 64-bit length = 2^20, no payload yet
+  auto buf = make_bytes({0x02, 0x7f, 0, 0, 0, 0, 0, 0x10, 0, 0, 'x'});
+
+  detail::frame_header header{};
+  auto status = detail::parse_header(
+    std::span<const std::byte>(buf.data(), buf.size()), header
+  );
+
+  REQUIRE(status == detail::parse_status::ok);
+
+  CHECK(header.op == detail::OpCode::binary);
+  CHECK(header.fin == false);
+  CHECK(header.payload_len == (1u << 20));
+  CHECK(header.len == 10);
+
+  detail::parse_output out{};
+  CHECK(
+    detail::parse_frame(
+      std::span<const std::byte>(buf.data(), buf.size()), out
+    ) == detail::parse_status::need_more
+  );
+}
@@ -1,7 +1,10 @@
 #include <doctest/doctest.h>
 
+#include <openssl/sha.h>
+
 #include <manet/protocol/websocket.hpp>
 #include <manet/reactor/io.hpp>
+#include <manet/utils/base64.hpp>
 
 using namespace manet;
 using namespace manet::protocol::websocket::detail;
@@ -248,4 +251,180 @@ TEST_CASE("read_handshake: error with wrong but valid key")
   CHECK(rx.rbuf().size() == 0);
 }
 
+TEST_CASE("read_handshake: resumes an incomplete response across reads")
+{
+  const std::string accept = VALID_ACCEPT_KEYS[1];
+  auto expected_key = make_accept_key(accept);
+
+  const auto handshake = make_valid_handshake(accept, {}, "ABCD");
+  const auto http_len = handshake.size() - 4;
+
+  reactor::Buffer<reactor::RX_CAP> buf{};
+  reactor::RxSource rx{&buf};
+
+  HandshakeParser parser{};
+
+  // deliver the response in 7 byte chunks
+  std::size_t fed = 0;
+  while (fed < handshake.size())
+  {
+    auto n = std::min<std::size_t>(7, handshake.size() - fed);
+    make_rx(buf, std::string_view(handshake).substr(fed, n));
+    fed += n;
+
+    const auto before = rx.rbuf().size();
+    const auto status = read_handshake(parser, expected_key, rx);
+
+    CHECK(status == protocol::Status::ok);
+
+    if (fed < http_len)
+    {
+      // nothing consumed, scan offset only ever points past complete lines
+      CHECK(rx.rbuf().size() == before);
+      CHECK(parser.scan <= fed);
+      CHECK((parser.scan == 0 || handshake[parser.scan - 1] == '\n'));
+    }
+    else
+    {
+      break;
+    }
+  }
+
+  CHECK(parser.status == 101);
+  CHECK(rx.rbuf().size() == fed - http_len);
+}
+
+TEST_CASE("read_handshake: parses status and header table")
+{
+  const std::string accept = VALID_ACCEPT_KEYS[2];
+  auto expected_key = make_accept_key(accept);
+
+  // clang-format off
+  std::string headers =
+    "upgrade: websocket\r\n"
+    "connection: Upgrade\r\n"
+    "sec-websocket-accept:" + accept + "  \r\n"
+    "Sec-WebSocket-Protocol: \tjson\r\n"
+    "Sec-WebSocket-Extensions: permessage-deflate\r\n";
+  // clang-format on
+
+  auto resp = make_http_response("HTTP/1.1 101 Switching Protocols", headers);
+
+  reactor::Buffer<reactor::RX_CAP> buf{};
+  auto rx = make_rx(buf, resp);
+  auto input = rx.rbuf();
+
+  HandshakeParser parser{};
+  const auto st = read_handshake(parser, expected_key, rx);
+
+  using Field = HandshakeParser::Field;
+
+  CHECK(st == protocol::Status::ok);
+  CHECK(parser.status == 101);
+  CHECK(parser.value(Field::accept, input) == accept);
+  CHECK(parser.value(Field::protocol, input) == "json");
+  CHECK(parser.value(Field::extensions, input) == "permessage-deflate");
+}
+
+TEST_CASE("read_handshake: rejects malformed status line and oversized response")
+{
+  auto expected_key = make_accept_key(VALID_ACCEPT_KEYS[0]);
+
+  SUBCASE("malformed status line")
+  {
+    auto resp = make_http_response("HTTP/1.1 1x1 ???", "Upgrade: websocket\r\n");
+
+    reactor::Buffer<reactor::RX_CAP> buf{};
+    auto rx = make_rx(buf, resp);
+
+    CHECK(read_handshake(expected_key, rx) == protocol::Status::error);
+    CHECK(rx.rbuf().size() == 0);
+  }
+
+  SUBCASE("unterminated response")
+  {
+    std::string resp = "HTTP/1.1 101 Switching Protocols\r\n";
+    while (resp.size() <= HandshakeParser::MAX_RESPONSE)
+    {
+      resp += "X-Padding: 0123456789abcdef\r\n";
+    }
+
+    reactor::Buffer<reactor::RX_CAP> buf{};
+    auto rx = make_rx(buf, resp);
+
+    CHECK(read_handshake(expected_key, rx) == protocol::Status::error);
+  }
+}
+
+TEST_CASE("write_request: fills the compiled template with a fresh key")
+{
+  std::vector<protocol::websocket::Header> extra = {
+    {"X-MBX-APIKEY", "secret"}, {"", "skipped"}
+  };
+
+  auto request = compile_request("example.com", "/ws/btcusdt@depth", extra);
+  REQUIRE(request.len != 0);
+
+  std::array<std::byte, 1024> out{};
+  std::array<char, 28> accept{};
+  std::string previous_key;
+
+  for (int i = 0; i < 2; i++)
+  {
+    auto len = write_request(request, out, accept);
+    REQUIRE(len == request.len);
+
+    std::string_view req(reinterpret_cast<const char *>(out.data()), len);
+    auto key = req.substr(request.key_offset, RequestTemplate::KEY_LEN);
+
+    // clang-format off
+    CHECK(req ==
+      "GET /ws/btcusdt@depth HTTP/1.1\r\n"
+      "Host: example.com\r\n"
+      "Upgrade: websocket\r\n"
+      "Connection: Upgrade\r\n"
+      "Sec-WebSocket-Key: " + std::string(key) + "\r\n"
+      "Sec-WebSocket-Version: 13\r\n"
+      "X-MBX-APIKEY: secret\r\n"
+      "\r\n");
+    // clang-format on
+
+    // every connect uses a new nonce
+    CHECK(key != previous_key);
+    previous_key = key;
+
+    // accept = base64(sha1(key ; GUID))
+    std::string scratch =
+      std::string(key) + "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+    std::array<std::byte, 20> sha1{};
+    SHA1(
+      reinterpret_cast<const uint8_t *>(scratch.data()), scratch.size(),
+      reinterpret_cast<uint8_t *>(sha1.data())
+    );
+    std::array<char, 28> expected{};
+    utils::base64_encode(sha1, expected);
+
+    CHECK(accept == expected);
+  }
+
+  SUBCASE("output too small")
+  {
+    CHECK(write_request(request, std::span(out).first(16), accept) == 0);
+  }
+}
+
+TEST_CASE("compile_request: rejects requests exceeding the template capacity")
+{
+  std::vector<protocol::websocket::Header> extra = {
+    {"X-Large", std::string(RequestTemplate::CAP, 'x')}
+  };
+
+  auto request = compile_request("example.com", "/", extra);
+  CHECK(request.len == 0);
+
+  std::array<std::byte, 64> out{};
+  std::array<char, 28> accept{};
+  CHECK(write_request(request, out, accept) == 0);
+}
+
 } // namespace
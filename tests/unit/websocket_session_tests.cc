@@ -0,0 +1,753 @@
+#include <doctest/doctest.h>
+
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <manet/protocol/websocket.hpp>
+#include <manet/reactor/io.hpp>
+
+using namespace manet;
+using namespace manet::protocol::websocket;
+
+namespace
+{
+
+/** unmasked server-to-client frame */
+std::string
+frame(detail::OpCode op, std::string_view payload, bool fin = true)
+{
+  std::string f;
+  f.push_back(static_cast<char>((fin ? 0x80 : 0x00) | uint8_t(op)));
+
+  if (payload.size() < 126)
+  {
+    f.push_back(static_cast<char>(payload.size()));
+  }
+  else if (payload.size() <= 0xFFFF)
+  {
+    f.push_back(static_cast<char>(126));
+    f.push_back(static_cast<char>(payload.size() >> 8));
+    f.push_back(static_cast<char>(payload.size() & 0xFF));
+  }
+  else
+  {
+    f.push_back(static_cast<char>(127));
+    for (int shift = 56; shift >= 0; shift -= 8)
+    {
+      f.push_back(static_cast<char>((uint64_t(payload.size()) >> shift)));
+    }
+  }
+
+  f += payload;
+  return f;
+}
+
+std::string to_string(std::span<const std::byte> s)
+{
+  return {reinterpret_cast<const char *>(s.data()), s.size()};
+}
+
+struct Trace
+{
+  std::vector<std::string> events;
+  std::string streamed;
+};
+
+/** records on_text / on_binary calls */
+struct PlainCodec
+{
+  using config_t = Trace *;
+
+  Trace *trace;
+
+  explicit PlainCodec(config_t trace) noexcept
+      : trace(trace)
+  {
+  }
+
+  protocol::Status
+  on_text(reactor::IO, std::span<const std::byte> payload) noexcept
+  {
+    trace->events.push_back("text:" + to_string(payload));
+    return protocol::Status::ok;
+  }
+
+  protocol::Status
+  on_binary(reactor::IO, std::span<const std::byte> payload) noexcept
+  {
+    trace->events.push_back("binary:" + to_string(payload));
+    return protocol::Status::ok;
+  }
+};
+
+/** records on_binary_batch calls */
+struct BatchCodec : PlainCodec
+{
+  using PlainCodec::PlainCodec;
+
+  protocol::Status on_binary_batch(
+    reactor::IO, std::span<const detail::frame_view> frames
+  ) noexcept
+  {
+    std::string s = "batch:";
+    for (auto &f : frames)
+    {
+      s += to_string(f.payload) + ";";
+    }
+    trace->events.push_back(s);
+    return protocol::Status::ok;
+  }
+};
+
+/** records on_binary_begin / on_binary_chunk / on_binary_end calls */
+struct StreamCodec
+{
+  using config_t = Trace *;
+
+  Trace *trace;
+
+  explicit StreamCodec(config_t trace) noexcept
+      : trace(trace)
+  {
+  }
+
+  protocol::Status on_binary_begin(reactor::IO) noexcept
+  {
+    trace->events.push_back("begin");
+    return protocol::Status::ok;
+  }
+
+  protocol::Status
+  on_binary_chunk(reactor::IO, std::span<const std::byte> chunk) noexcept
+  {
+    trace->events.push_back("chunk");
+    trace->streamed += to_string(chunk);
+    return protocol::Status::ok;
+  }
+
+  protocol::Status on_binary_end(reactor::IO) noexcept
+  {
+    trace->events.push_back("end");
+    return protocol::Status::ok;
+  }
+};
+
+/** takes `room` BINARY messages, pauses on the next one */
+struct PausingCodec : PlainCodec
+{
+  using PlainCodec::PlainCodec;
+
+  int room = 0;
+
+  protocol::Status
+  on_binary(reactor::IO io, std::span<const std::byte> payload) noexcept
+  {
+    if (room == 0)
+    {
+      return protocol::Status::pause;
+    }
+
+    room--;
+    return PlainCodec::on_binary(io, payload);
+  }
+};
+
+template <typename Codec, typename Policy = DefaultPolicy> struct Harness
+{
+  using Session = typename WebSocket<Codec, Policy>::Session;
+
+  Trace trace;
+  typename WebSocket<Codec, Policy>::config_t config{
+    .path = "/", .extra = {}, .codec_config = &trace
+  };
+
+  // sessions are large (message buffer), keep them off the stack
+  std::unique_ptr<Session> session =
+    std::make_unique<Session>("localhost", 80, config);
+
+  std::unique_ptr<reactor::Buffer<reactor::RX_CAP>> rx =
+    std::make_unique<reactor::Buffer<reactor::RX_CAP>>();
+  std::unique_ptr<reactor::Buffer<reactor::TX_CAP>> tx =
+    std::make_unique<reactor::Buffer<reactor::TX_CAP>>();
+
+  Harness() { session->state = Session::State::listening; }
+
+  void feed(std::string_view data)
+  {
+    auto w = rx->wbuf();
+    REQUIRE(data.size() <= w.size());
+    std::memcpy(w.data(), data.data(), data.size());
+    rx->inc_wpos(data.size());
+  }
+
+  /** what the connection hands to the transport (RX or the read target) */
+  reactor::RxSink sink()
+  {
+    return {rx.get(), rx->rbuf().empty() ? session->read_target() : nullptr};
+  }
+
+  void transport_read(std::string_view data)
+  {
+    auto in = sink();
+    REQUIRE(data.size() <= in.wbuf().size());
+    std::memcpy(in.wbuf().data(), data.data(), data.size());
+    in.wrote(data.size());
+  }
+
+  protocol::Status on_data()
+  {
+    return session->on_data(
+      reactor::IO{reactor::RxSource{rx.get()}, reactor::TxSink{tx.get()}}
+    );
+  }
+};
+
+using detail::OpCode;
+
+TEST_CASE("Session::on_data dispatches all complete frames in one call")
+{
+  Harness<PlainCodec> h;
+
+  h.feed(
+    frame(OpCode::binary, "a") + frame(OpCode::text, "b") +
+    frame(OpCode::binary, "c") + frame(OpCode::binary, "d").substr(0, 2)
+  );
+
+  CHECK(h.on_data() == protocol::Status::ok);
+
+  CHECK(
+    h.trace.events ==
+    std::vector<std::string>{"binary:a", "text:b", "binary:c"}
+  );
+
+  // the partial frame is left in RX
+  CHECK(h.rx->rbuf().size() == 2);
+}
+
+TEST_CASE("Session::on_data batches consecutive binary frames")
+{
+  Harness<BatchCodec> h;
+
+  SUBCASE("text and fragmented messages split batches (order is preserved)")
+  {
+    h.feed(
+      frame(OpCode::binary, "a") + frame(OpCode::binary, "b") +
+      frame(OpCode::text, "t") + frame(OpCode::binary, "c") +
+      frame(OpCode::binary, "x", false) + frame(OpCode::cont, "y") +
+      frame(OpCode::binary, "d")
+    );
+
+    CHECK(h.on_data() == protocol::Status::ok);
+
+    CHECK(
+      h.trace.events == std::vector<std::string>{
+                          "batch:a;b;", "text:t", "batch:c;", "binary:xy",
+                          "batch:d;"
+                        }
+    );
+    CHECK(h.rx->rbuf().empty());
+  }
+
+  SUBCASE("batches are bounded by BATCH_CAP")
+  {
+    using Session = Harness<BatchCodec>::Session;
+    constexpr std::size_t N = Session::BATCH_CAP + 3;
+
+    std::string input;
+    for (std::size_t i = 0; i < N; i++)
+    {
+      input += frame(OpCode::binary, "z");
+    }
+    h.feed(input);
+
+    CHECK(h.on_data() == protocol::Status::ok);
+
+    REQUIRE(h.trace.events.size() == 2);
+    CHECK(h.trace.events[0].size() == 6 + 2 * Session::BATCH_CAP);
+    CHECK(h.trace.events[1] == "batch:z;z;z;");
+  }
+
+  SUBCASE("PING in a burst is answered once the burst is parsed")
+  {
+    h.feed(
+      frame(OpCode::binary, "a") + frame(OpCode::ping, "p") +
+      frame(OpCode::binary, "b")
+    );
+
+    CHECK(h.on_data() == protocol::Status::ok);
+
+    CHECK(h.trace.events == std::vector<std::string>{"batch:a;", "batch:b;"});
+
+    // masked PONG: header (2) + mask (4) + payload (1)
+    auto pong = h.tx->rbuf();
+    REQUIRE(pong.size() == 7);
+    CHECK(pong[0] == std::byte{0x80 | uint8_t(OpCode::pong)});
+  }
+
+  SUBCASE("CLOSE stops dispatching")
+  {
+    h.feed(
+      frame(OpCode::binary, "a") + frame(OpCode::close, "\x03\xe8") +
+      frame(OpCode::binary, "b")
+    );
+
+    CHECK(h.on_data() == protocol::Status::close);
+    CHECK(h.trace.events == std::vector<std::string>{"batch:a;"});
+  }
+}
+
+TEST_CASE("Session hands paused messages over again")
+{
+  Harness<PausingCodec> h;
+  auto &codec = h.session->codec;
+
+  auto c = frame(OpCode::binary, "c");
+
+  h.feed(
+    frame(OpCode::binary, "a") + frame(OpCode::binary, "x", false) +
+    frame(OpCode::cont, "y") + c
+  );
+
+  // the fragmented message is assembled (consumed), then held
+  codec.room = 1;
+  CHECK(h.on_data() == protocol::Status::pause);
+  CHECK(h.trace.events == std::vector<std::string>{"binary:a"});
+  CHECK(to_string(h.rx->rbuf()) == c);
+
+  // a single frame stays in RX
+  codec.room = 1;
+  CHECK(h.on_data() == protocol::Status::pause);
+  CHECK(h.trace.events == std::vector<std::string>{"binary:a", "binary:xy"});
+  CHECK(to_string(h.rx->rbuf()) == c);
+
+  codec.room = 1;
+  CHECK(h.on_data() == protocol::Status::ok);
+  CHECK(
+    h.trace.events ==
+    std::vector<std::string>{"binary:a", "binary:xy", "binary:c"}
+  );
+  CHECK(h.rx->rbuf().empty());
+}
+
+TEST_CASE("Session reads large payloads straight into the message buffer")
+{
+  Harness<PlainCodec> h;
+
+  using Session = Harness<PlainCodec>::Session;
+
+  SUBCASE("frame larger than RX")
+  {
+    // header + payload exceed RX_CAP, only the message buffer can hold it
+    std::string payload(Session::MSG_CAP, 'q');
+    auto input = frame(OpCode::binary, payload);
+    REQUIRE(reactor::RX_CAP < input.size());
+
+    h.transport_read(std::string_view{input}.substr(0, 110));
+    CHECK(h.on_data() == protocol::Status::ok);
+
+    // the header was parsed once and the payload prefix moved out of RX
+    CHECK(h.rx->rbuf().empty());
+    CHECK(h.trace.events.empty());
+
+    auto *target = h.session->read_target();
+    REQUIRE(target != nullptr);
+    CHECK(target->buf.size() == Session::MSG_CAP - 100);
+
+    std::string_view rest = std::string_view{input}.substr(110);
+    while (!rest.empty())
+    {
+      auto n = std::min<std::size_t>(rest.size(), 1 << 16);
+      h.transport_read(rest.substr(0, n));
+      rest.remove_prefix(n);
+
+      CHECK(h.rx->rbuf().empty());
+      CHECK(h.on_data() == protocol::Status::ok);
+    }
+
+    REQUIRE(h.trace.events.size() == 1);
+    CHECK(h.trace.events[0] == "binary:" + payload);
+    CHECK(h.session->read_target() == nullptr);
+  }
+
+  SUBCASE("tail that arrives through RX")
+  {
+    std::string payload(Session::DIRECT_MIN + 10, 'q');
+    auto input = frame(OpCode::binary, payload, false) +
+                 frame(OpCode::cont, "!") + frame(OpCode::text, "next");
+
+    h.feed(std::string_view{input}.substr(0, 9));
+    CHECK(h.on_data() == protocol::Status::ok);
+    REQUIRE(h.session->read_target() != nullptr);
+
+    // the connection only hands out the target while RX is empty
+    h.feed(std::string_view{input}.substr(9));
+    CHECK(h.on_data() == protocol::Status::ok);
+
+    CHECK(
+      h.trace.events ==
+      std::vector<std::string>{"binary:" + payload + "!", "text:next"}
+    );
+    CHECK(h.rx->rbuf().empty());
+  }
+
+  SUBCASE("short tails wait in RX")
+  {
+    std::string payload(Session::DIRECT_MIN - 1, 'q');
+    auto input = frame(OpCode::binary, payload);
+
+    h.feed(std::string_view{input}.substr(0, 4));
+    CHECK(h.on_data() == protocol::Status::ok);
+
+    CHECK(h.session->read_target() == nullptr);
+    CHECK(h.rx->rbuf().size() == 4);
+  }
+
+  SUBCASE("payload exceeding the message buffer is rejected")
+  {
+    auto input = frame(OpCode::binary, std::string(Session::MSG_CAP + 1, 'q'));
+
+    h.feed(std::string_view{input}.substr(0, 64));
+    CHECK(h.on_data() == protocol::Status::error);
+  }
+}
+
+TEST_CASE("Session streams BINARY messages to on_binary_chunk")
+{
+  Harness<StreamCodec> h;
+
+  using Session = Harness<StreamCodec>::Session;
+
+  SUBCASE("fragments are delivered as they arrive")
+  {
+    h.feed(
+      frame(OpCode::binary, "ab", false) + frame(OpCode::ping, "p") +
+      frame(OpCode::cont, "cd", false)
+    );
+
+    CHECK(h.on_data() == protocol::Status::ok);
+    CHECK(
+      h.trace.events == std::vector<std::string>{"begin", "chunk", "chunk"}
+    );
+    CHECK(h.tx->rbuf().size() == 7); // PONG
+
+    h.feed(frame(OpCode::cont, "ef"));
+
+    CHECK(h.on_data() == protocol::Status::ok);
+    CHECK(
+      h.trace.events ==
+      std::vector<std::string>{"begin", "chunk", "chunk", "chunk", "end"}
+    );
+    CHECK(h.trace.streamed == "abcdef");
+    CHECK(h.session->msg_len == 0);
+  }
+
+  SUBCASE("messages larger than MSG_CAP are streamed from RX")
+  {
+    std::string payload(2 * Session::MSG_CAP, 'q');
+    for (std::size_t i = 0; i < payload.size(); i += 4099)
+    {
+      payload[i] = static_cast<char>('a' + i % 26);
+    }
+
+    auto input = frame(OpCode::binary, payload) + frame(OpCode::binary, "x");
+
+    std::string_view rest = input;
+    std::size_t reads = 0;
+
+    while (!rest.empty())
+    {
+      // the payload is never redirected to the message buffer
+      CHECK(h.sink().target == nullptr);
+
+      auto n = std::min<std::size_t>(rest.size(), 1 << 16);
+      h.feed(rest.substr(0, n));
+      rest.remove_prefix(n);
+      reads++;
+
+      CHECK(h.on_data() == protocol::Status::ok);
+      CHECK(h.rx->rbuf().empty());
+    }
+
+    // one chunk per read, then the trailing single frame message
+    REQUIRE(h.trace.events.size() == reads + 5);
+    CHECK(h.trace.events.front() == "begin");
+    CHECK(h.trace.events[reads + 1] == "end");
+    CHECK(h.trace.streamed == payload + "x");
+  }
+}
+
+/** binary feed without PONGs */
+struct QuietFeedPolicy : BinaryFeedPolicy
+{
+  static constexpr bool control = false;
+};
+
+TEST_CASE("Session compiles out features disabled by the policy")
+{
+  using Feed = Harness<BatchCodec, BinaryFeedPolicy>;
+
+  static_assert(sizeof(Feed::Session) <= BinaryFeedPolicy::session_budget);
+  static_assert(
+    sizeof(Feed::Session) + DefaultPolicy::max_message_size <=
+    sizeof(Harness<BatchCodec>::Session)
+  );
+
+  Feed h;
+
+  SUBCASE("single-frame BINARY messages are delivered")
+  {
+    h.feed(frame(OpCode::binary, "a") + frame(OpCode::binary, "b"));
+
+    CHECK(h.on_data() == protocol::Status::ok);
+    CHECK(h.trace.events == std::vector<std::string>{"batch:a;b;"});
+  }
+
+  SUBCASE("TEXT is a protocol error")
+  {
+    h.feed(frame(OpCode::text, "t"));
+
+    CHECK(h.on_data() == protocol::Status::error);
+    CHECK(h.trace.events.empty());
+  }
+
+  SUBCASE("fragmented messages are a protocol error")
+  {
+    h.feed(frame(OpCode::binary, "a", false) + frame(OpCode::cont, "b"));
+
+    CHECK(h.on_data() == protocol::Status::error);
+  }
+
+  SUBCASE("large frames wait in RX (no message buffer)")
+  {
+    auto input = frame(OpCode::binary, std::string(1 << 16, 'q'));
+
+    h.feed(std::string_view{input}.substr(0, 1 << 10));
+    CHECK(h.on_data() == protocol::Status::ok);
+    CHECK(h.session->read_target() == nullptr);
+
+    h.feed(std::string_view{input}.substr(1 << 10));
+    CHECK(h.on_data() == protocol::Status::ok);
+    REQUIRE(h.trace.events.size() == 1);
+    CHECK(h.trace.events[0].size() == 6 + (1 << 16) + 1);
+  }
+
+  SUBCASE("PING is only answered if control frames are enabled")
+  {
+    Harness<BatchCodec, QuietFeedPolicy> quiet;
+
+    h.feed(frame(OpCode::ping, "p"));
+    quiet.feed(frame(OpCode::ping, "p"));
+
+    CHECK(h.on_data() == protocol::Status::ok);
+    CHECK(quiet.on_data() == protocol::Status::ok);
+
+    CHECK(h.tx->rbuf().size() == 7);
+    CHECK(quiet.tx->rbuf().empty());
+  }
+}
+
+/** message buffer and streaming, but no fragmented messages */
+struct UnfragmentedPolicy : DefaultPolicy
+{
+  static constexpr bool fragmentation = false;
+};
+
+TEST_CASE("Session rejects large fragments that arrive in pieces")
+{
+  std::string payload(1 << 13, 'q');
+
+  auto first_read = [](const std::string &input)
+  { return std::string_view{input}.substr(0, 64); };
+
+  SUBCASE("into the message buffer")
+  {
+    Harness<PlainCodec, UnfragmentedPolicy> h;
+
+    auto input = frame(OpCode::binary, payload, false);
+    h.transport_read(first_read(input));
+
+    CHECK(h.on_data() == protocol::Status::error);
+    CHECK(h.session->read_target() == nullptr);
+  }
+
+  SUBCASE("continuation into the message buffer")
+  {
+    Harness<PlainCodec, UnfragmentedPolicy> h;
+
+    auto input = frame(OpCode::cont, payload);
+    h.transport_read(first_read(input));
+
+    CHECK(h.on_data() == protocol::Status::error);
+  }
+
+  SUBCASE("streamed")
+  {
+    Harness<StreamCodec, UnfragmentedPolicy> h;
+
+    auto input = frame(OpCode::binary, payload, false);
+    h.transport_read(first_read(input));
+
+    CHECK(h.on_data() == protocol::Status::error);
+    CHECK(h.trace.events.empty());
+  }
+
+  SUBCASE("a large single frame is still read in pieces")
+  {
+    Harness<PlainCodec, UnfragmentedPolicy> h;
+
+    auto input = frame(OpCode::binary, payload);
+    h.transport_read(first_read(input));
+    CHECK(h.on_data() == protocol::Status::ok);
+
+    h.transport_read(std::string_view{input}.substr(64));
+    CHECK(h.on_data() == protocol::Status::ok);
+
+    CHECK(h.trace.events == std::vector<std::string>{"binary:" + payload});
+  }
+}
+
+/** unmask a client-to-server frame (short payload) */
+std::string unmask(std::span<const std::byte> frame)
+{
+  REQUIRE(6 <= frame.size());
+  REQUIRE((uint8_t(frame[1]) & 0x80) != 0);
+
+  std::string payload;
+  for (std::size_t i = 6; i < frame.size(); i++)
+  {
+    payload.push_back(static_cast<char>(frame[i] ^ frame[2 + (i - 6) % 4]));
+  }
+  return payload;
+}
+
+TEST_CASE("Session::heartbeat measures RTT and detects dead peers")
+{
+  using namespace std::chrono_literals;
+
+  Stats stats;
+
+  Harness<PlainCodec> h;
+  h.session->stats = &stats;
+  h.session->pong_deadline = 100ms;
+
+  auto heartbeat = [&]()
+  { return h.session->heartbeat(reactor::TxSink{h.tx.get()}); };
+
+  SUBCASE("PONG echoing the timestamp records the RTT")
+  {
+    CHECK(heartbeat() == protocol::Status::ok);
+
+    // PING with an 8 byte send time
+    auto ping = h.tx->rbuf();
+    REQUIRE(ping.size() == 14);
+    CHECK(ping[0] == std::byte{0x80 | uint8_t(OpCode::ping)});
+
+    auto payload = unmask(ping);
+    h.tx->clear();
+
+    // one PING in flight
+    CHECK(heartbeat() == protocol::Status::ok);
+    CHECK(h.tx->rbuf().empty());
+
+    // unsolicited PONG is ignored
+    h.feed(frame(OpCode::pong, "12345678"));
+    CHECK(h.on_data() == protocol::Status::ok);
+    CHECK(stats.rtt_ns.count() == 0);
+
+    h.feed(frame(OpCode::pong, payload));
+    CHECK(h.on_data() == protocol::Status::ok);
+
+    CHECK(stats.rtt_ns.count() == 1);
+    CHECK(
+      h.session->ping_sent ==
+      Harness<PlainCodec>::Session::clock::time_point{}
+    );
+
+    // next heartbeat sends the next PING
+    CHECK(heartbeat() == protocol::Status::ok);
+    CHECK(h.tx->rbuf().size() == 14);
+  }
+
+  SUBCASE("overdue PONG drops the connection")
+  {
+    CHECK(heartbeat() == protocol::Status::ok);
+
+    h.session->ping_sent -= 50ms;
+    CHECK(heartbeat() == protocol::Status::ok);
+
+    h.session->ping_sent -= 100ms;
+    CHECK(heartbeat() == protocol::Status::close);
+    CHECK(stats.pong_timeouts == 1);
+  }
+
+  SUBCASE("stale stream drops the connection")
+  {
+    h.session->stale_after = 1s;
+    h.session->last_rx -= 2s;
+
+    CHECK(heartbeat() == protocol::Status::close);
+    CHECK(stats.stale_timeouts == 1);
+
+    // any data refreshes the stream
+    h.feed(frame(OpCode::binary, "a"));
+    CHECK(h.on_data() == protocol::Status::ok);
+    CHECK(heartbeat() == protocol::Status::ok);
+  }
+
+  SUBCASE("resuming after a pause starts the clocks over")
+  {
+    CHECK(heartbeat() == protocol::Status::ok);
+    h.tx->clear();
+
+    // paused for longer than either deadline
+    h.session->stale_after = 1s;
+    h.session->ping_sent -= 200ms;
+    h.session->last_rx -= 2s;
+    h.session->on_resume();
+
+    CHECK(heartbeat() == protocol::Status::ok);
+    CHECK(h.tx->rbuf().size() == 14); // (a new PING)
+  }
+
+  SUBCASE("no PING before the handshake completed")
+  {
+    h.session->state = Harness<PlainCodec>::Session::State::handshake_sent;
+
+    CHECK(heartbeat() == protocol::Status::ok);
+    CHECK(h.tx->rbuf().empty());
+  }
+}
+
+TEST_CASE("Session::reset starts over but keeps the compiled request")
+{
+  Harness<PlainCodec> h;
+
+  // mid-message: a fragment is buffered
+  h.feed(frame(OpCode::binary, "x", false));
+  CHECK(h.on_data() == protocol::Status::ok);
+  REQUIRE(0 < h.session->msg_len);
+
+  // (not compiled again: a changed config does not show)
+  h.config.path = "/other";
+  h.session->reset(h.config);
+
+  CHECK(h.session->msg_len == 0);
+  CHECK(h.session->remaining == 0);
+  CHECK(!h.session->established());
+
+  CHECK(
+    h.session->on_connect(
+      reactor::IO{reactor::RxSource{h.rx.get()}, reactor::TxSink{h.tx.get()}}
+    ) == protocol::Status::ok
+  );
+
+  auto out = h.tx->rbuf();
+  std::string_view request(
+    reinterpret_cast<const char *>(out.data()), out.size()
+  );
+  CHECK(request.starts_with("GET / HTTP/1.1\r\nHost: localhost\r\n"));
+}
+
+} // namespace